@@ -1,6 +1,7 @@
 #pragma once
 
 // global headers
+#include <functional>
 #include <memory>
 #include <string>
 #include <sys/types.h>
@@ -38,6 +39,17 @@ namespace appimage::update {
             VALIDATION_BAD_SIGNATURE,
         };
 
+        // Callbacks which can be used to get notified about the progress of an update instead of polling
+        // They are called from a separate thread, one at a time. Callbacks must not destroy the Updater instance.
+        // Called with the current progress, and the number of bytes done and in total. If the size of the remote file
+        // is not known yet, the byte counts are -1.
+        typedef std::function<void(double progress, long long bytesDone, long long bytesTotal)> ProgressCallback;
+        // Called whenever the state of the update changes. The last call reports either SUCCESS or ERROR.
+        typedef std::function<void(State state)> StateCallback;
+        // Called for every status message. If set, the messages are not available via nextStatusMessage() during
+        // the update.
+        typedef std::function<void(const std::string& message)> StatusMessageCallback;
+
     private:
         // opaque private class
         // without this pattern, the header would require C++11, which is undesirable
@@ -54,7 +66,7 @@ namespace appimage::update {
         // as-is
         explicit Updater(const std::string& pathToAppImage, bool overwrite = false);
 
-        // declared merely for unique_ptr to work
+        // if the update is still running, it is stopped, and the update thread cleans up in the background
         ~Updater();
 
     public:
@@ -63,6 +75,8 @@ namespace appimage::update {
 
         // Interrupt update process as soon as possible. Throws exception if the update has not been started.
         // Returns false if stop() has been called already.
+        // The state changes to STOPPING until the update has been cleaned up, then to ERROR. Files created by the
+        // update are removed, and the original AppImage is restored if it has been replaced already.
         bool stop();
 
         // Returns current state of the updater.
@@ -126,5 +140,46 @@ namespace appimage::update {
 
         // copy permissions of the original AppImage to the new version
         void copyPermissionsToNewFile();
+
+        // Set callbacks to be notified about the progress of the update
+        // Must be called before start(). See the callback type declarations for more information.
+        void setProgressCallback(ProgressCallback callback);
+        void setStateCallback(StateCallback callback);
+        void setStatusMessageCallback(StatusMessageCallback callback);
+
+        // Set the minimum interval between two progress notifications in milliseconds (default: 100)
+        // State changes and status messages are delivered right away.
+        void setCallbackInterval(unsigned int milliseconds);
+
+        // Use the given file as an additional source of blocks for the new file, besides the original AppImage
+        // Useful for other AppImages sharing the same runtime or libraries, or other versions of the same application
+        // Must be called before start().
+        void addSeedFile(const std::string& path);
+
+        // If enabled, other AppImages in the same directory are used as additional seed files, too (disabled by default)
+        // Those with the most similar file names are preferred, their number is limited.
+        void setUseSiblingSeedFiles(bool useSiblingSeedFiles);
+
+        // Enable or disable the persistent hash cache used during signature validation (enabled by default)
+        // When enabled, the digests of AppImages which have not changed since the last validation are not recalculated
+        void setUseHashCache(bool useHashCache);
+
+        // Set the bounds for the ranges optimization threshold in bytes (default: 16 kiB to 4 MiB)
+        // zsync merges the ranges it needs to fetch if the gap between them is smaller than the threshold, which
+        // reduces the number of round trips at the cost of downloading unneeded data. If the connection is measured
+        // (see setMeasureConnection()), the threshold is chosen based on the round trip time and throughput, otherwise
+        // a default of 256 kiB is clamped to the bounds. On metered connections, a low maximum limits the amount of
+        // data fetched needlessly. Setting both bounds to the same value disables the measurements.
+        // Must be called before start().
+        void setRangesOptimizationThresholdBounds(unsigned long minimum, unsigned long maximum);
+
+        // Enable or disable measuring the connection before the download (disabled by default)
+        // The measurements cost two HEAD requests and a range request of up to 256 kiB for the .zsync file. They are
+        // reused for further updates from the same host. Update checks don't measure anything.
+        // Must be called before start().
+        void setMeasureConnection(bool measureConnection);
+
+        // Returns the ranges optimization threshold chosen for this update, or 0 if it has not been chosen yet
+        unsigned long rangesOptimizationThreshold() const;
     };
 }
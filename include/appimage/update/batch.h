@@ -0,0 +1,97 @@
+#pragma once
+
+// global headers
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// local headers
+#include "appimage/update.h"
+
+namespace appimage::update {
+    /**
+     * Checks and updates many AppImages at once, using a bounded pool of worker threads.
+     *
+     * Every AppImage is handled by an Updater instance the same way appimageupdatetool handles a single AppImage:
+     * check for changes, update, validate the signature, and copy the permissions to the new file (or restore the
+     * original file in case of validation errors).
+     *
+     * Besides the number of workers, the number of concurrent network operations (update checks and downloads) and
+     * disk operations (writing new files, calculating digests) can be limited separately.
+     */
+    class BatchUpdater {
+    public:
+        // Outcome of processing an AppImage
+        enum Status {
+            STATUS_UP_TO_DATE,
+            // only used when checking for updates only
+            STATUS_UPDATE_AVAILABLE,
+            STATUS_UPDATED,
+            STATUS_FAILED,
+        };
+
+        struct Result {
+            std::string pathToAppImage;
+            Status status = STATUS_FAILED;
+
+            // only set if the AppImage has been updated
+            std::string pathToNewFile;
+            Updater::ValidationState validationState = Updater::VALIDATION_FAILED;
+
+            // short, human readable description of the outcome
+            std::string message;
+
+            // all status messages issued by the Updater
+            std::vector<std::string> statusMessages;
+        };
+
+        // called from the worker threads (one at a time) as soon as an AppImage has been processed
+        typedef std::function<void(const Result& result)> ResultCallback;
+
+    private:
+        // opaque private class
+        class Private;
+        std::unique_ptr<Private> d;
+
+    public:
+        // overwrite has the same meaning as in Updater's constructor
+        explicit BatchUpdater(std::vector<std::string> pathsToAppImages, bool overwrite = false);
+        ~BatchUpdater();
+
+    public:
+        // Returns the paths of all AppImages within the given directory, sorted by name. Subdirectories are not
+        // searched. Throws std::invalid_argument if the directory cannot be read.
+        static std::vector<std::string> findAppImages(const std::string& directory);
+
+        // Set the number of worker threads (default: 4). If the network or disk limits have not been set explicitly,
+        // they default to this number.
+        void setJobs(unsigned int jobs);
+
+        // Set the maximum number of concurrent network and disk operations
+        void setNetworkJobs(unsigned int networkJobs);
+        void setDiskJobs(unsigned int diskJobs);
+
+        // If enabled, only checks for updates (STATUS_UP_TO_DATE or STATUS_UPDATE_AVAILABLE), nothing is downloaded
+        void setCheckOnly(bool checkOnly);
+
+        // If enabled, the original AppImages are removed after successful updates
+        void setRemoveOldFiles(bool removeOldFiles);
+
+        // See Updater::addSeedFile() and Updater::setUseSiblingSeedFiles()
+        void addSeedFile(const std::string& path);
+        void setUseSiblingSeedFiles(bool useSiblingSeedFiles);
+
+        // See Updater::setUseHashCache()
+        void setUseHashCache(bool useHashCache);
+
+        // See Updater::setMeasureConnection()
+        void setMeasureConnection(bool measureConnection);
+
+        void setResultCallback(ResultCallback callback);
+
+        // Processes all AppImages, and blocks until all of them have been processed
+        // Returns the results in the order of the paths passed to the constructor
+        std::vector<Result> run();
+    };
+}
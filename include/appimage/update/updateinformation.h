@@ -0,0 +1,34 @@
+#pragma once
+
+// global headers
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace appimage::update {
+    // Builds the URL of the .zsync file from the components of the update information, i.e., the update information
+    // split at "|", the first component being the type name. Status messages may be passed to the callback.
+    // Invalid update information or failures to resolve the URL must be reported by throwing an exception derived from
+    // std::exception. Its message is shown to the user.
+    typedef std::function<std::string(
+        const std::vector<std::string>& updateInformationComponents,
+        const std::function<void(const std::string& message)>& issueStatusMessage
+    )> UpdateInformationResolver;
+
+    /**
+     * Registers an update information type, so that AppImages using it can be checked, updated and described like
+     * those using one of the built-in types.
+     *
+     * Registering a type name a second time replaces the previous resolver, including those of the built-in types.
+     * Types can be registered at any time, they apply to all Updater instances created afterwards.
+     *
+     * @param typeName first component of the update information, e.g., "my-server-zsync"
+     * @param description human-readable name of the type, e.g., "ZSync via my server"
+     * @param resolver see above
+     */
+    void registerUpdateInformationType(
+        const std::string& typeName,
+        const std::string& description,
+        UpdateInformationResolver resolver
+    );
+}
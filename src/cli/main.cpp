@@ -1,9 +1,10 @@
 // system headers
-#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
-#include <thread>
+#include <mutex>
 #include <unistd.h>
 #include <optional>
 
@@ -12,12 +13,115 @@
 
 // local headers
 #include "appimage/update.h"
+#include "appimage/update/batch.h"
 #include "util/util.h"
 
 using namespace std;
 using namespace appimage::update;
 using namespace appimage::update::util;
 
+// updates (or checks) all AppImages passed on the commandline, including the ones in directories passed
+int runBatchUpdate(argagg::parser_results& args) {
+    std::vector<std::string> paths;
+
+    for (size_t i = 0; i < args.pos.size(); ++i) {
+        const auto path = abspath(args.as<string>(i));
+
+        if (std::filesystem::is_directory(path)) {
+            try {
+                const auto appImagesInDirectory = BatchUpdater::findAppImages(path);
+                paths.insert(paths.end(), appImagesInDirectory.begin(), appImagesInDirectory.end());
+            } catch (const std::invalid_argument& e) {
+                cerr << e.what() << endl;
+                return 1;
+            }
+        } else if (isFile(path)) {
+            paths.emplace_back(path);
+        } else {
+            cerr << "Could not read file: " << path << endl;
+            return 1;
+        }
+    }
+
+    if (paths.empty()) {
+        cerr << "No AppImages found, exiting." << endl;
+        return 0;
+    }
+
+    const auto jobs = args["jobs"].as<unsigned int>(4);
+
+    if (jobs == 0) {
+        cerr << "Error: --jobs must be at least 1." << endl;
+        return 1;
+    }
+
+    const bool checkOnly = args["checkForUpdate"];
+
+    BatchUpdater batchUpdater(paths, args["overwriteOldFile"]);
+    batchUpdater.setJobs(jobs);
+    batchUpdater.setCheckOnly(checkOnly);
+    batchUpdater.setRemoveOldFiles(args["removeOldFile"]);
+    batchUpdater.setUseHashCache(!args["noHashCache"]);
+    batchUpdater.setUseSiblingSeedFiles(args["seedSiblings"]);
+    batchUpdater.setMeasureConnection(args["measureConnection"]);
+
+    for (const auto& seed : args["seed"].all)
+        batchUpdater.addSeedFile(seed.arg);
+
+    size_t processedCount = 0;
+
+    // the callback is never called concurrently
+    batchUpdater.setResultCallback([&processedCount, &paths](const BatchUpdater::Result& result) {
+        ++processedCount;
+
+        cerr << "[" << processedCount << "/" << paths.size() << "] " << result.pathToAppImage << ": " << result.message << endl;
+
+        // the details are only of interest if something went wrong
+        if (result.status == BatchUpdater::STATUS_FAILED) {
+            for (const auto& message : result.statusMessages)
+                cerr << "    " << message << endl;
+        }
+    });
+
+    cerr << (checkOnly ? "Checking " : "Updating ") << paths.size() << " AppImage(s) using " << jobs << " job(s)..." << endl;
+
+    const auto results = batchUpdater.run();
+
+    size_t failedCount = 0;
+    size_t updatableCount = 0;
+
+    cout << endl << "Summary:" << endl;
+
+    for (const auto& result : results) {
+        switch (result.status) {
+            case BatchUpdater::STATUS_UP_TO_DATE:
+                cout << "  up to date:        " << result.pathToAppImage << endl;
+                break;
+            case BatchUpdater::STATUS_UPDATE_AVAILABLE:
+                ++updatableCount;
+                cout << "  update available:  " << result.pathToAppImage << endl;
+                break;
+            case BatchUpdater::STATUS_UPDATED:
+                ++updatableCount;
+                cout << "  updated:           " << result.pathToAppImage << " -> " << result.pathToNewFile << endl;
+                break;
+            case BatchUpdater::STATUS_FAILED:
+                ++failedCount;
+                cout << "  failed:            " << result.pathToAppImage << " (" << result.message << ")" << endl;
+                break;
+        }
+    }
+
+    if (failedCount > 0)
+        return checkOnly ? 2 : 1;
+
+    // same exit codes as for a single AppImage
+    if (checkOnly)
+        return updatableCount > 0 ? 1 : 0;
+
+    return 0;
+}
+
 int main(const int argc, const char** argv) {
     argagg::parser parser{{
         {"help", {"-h", "--help"}, "Display this help text."},
@@ -29,6 +133,11 @@ int main(const int argc, const char** argv) {
         {"removeOldFile", {"-r", "--remove-old"}, "Remove old AppImage after successful update."},
         {"updateInfo", {"-u", "--update-info"}, "Manually override update information in the AppImage.", 1},
         {"selfUpdate", {"--self-update"}, "Update this AppImage."},
+        {"noHashCache", {"--no-hash-cache"}, "Do not use cached digests of unchanged AppImages during signature validation."},
+        {"seed", {"--seed"}, "Use given file as an additional source of data for the update. Can be specified multiple times.", 1},
+        {"seedSiblings", {"--seed-siblings"}, "Use other AppImages in the same directory as additional sources of data for the update."},
+        {"measureConnection", {"--measure-connection"}, "Measure the connection to the server before downloading, and merge the ranges to download accordingly."},
+        {"jobs", {"--jobs"}, "Number of AppImages to process in parallel when multiple AppImages or a directory are passed (default: 4).", 1},
     }};
 
     argagg::parser_results args;
@@ -42,7 +151,7 @@ int main(const int argc, const char** argv) {
 
     const auto showUsage = [argv, &parser]() {
         std::cerr << "AppImage companion tool taking care of updates for the commandline." << endl << endl;
-        cerr << "Usage: " << argv[0] << " [options...] [<path to AppImage>]" << endl << endl;
+        cerr << "Usage: " << argv[0] << " [options...] [<path to AppImage or directory>...]" << endl << endl;
         cerr << parser;
     };
 
@@ -58,6 +167,20 @@ int main(const int argc, const char** argv) {
         return 0;
     }
 
+    // multiple AppImages (or a directory containing AppImages) are processed in parallel
+    const bool batchMode = args["jobs"] || args.pos.size() > 1 ||
+                           (args.pos.size() == 1 && std::filesystem::is_directory(args.as<string>(0)));
+
+    if (batchMode) {
+        if (args["selfUpdate"] || args["describe"] || args["updateInfo"]) {
+            cerr << "Error: --self-update, --describe and --update-info cannot be used with multiple AppImages." << endl;
+            showUsage();
+            return EXIT_FAILURE;
+        }
+
+        return runBatchUpdate(args);
+    }
+
     optional<string> pathToAppImage = [&args]() {
         if (!args.pos.empty()) {
             // calculate absolute path to normalize the path for when it's
@@ -112,6 +235,22 @@ int main(const int argc, const char** argv) {
     if (args["updateInfo"]) {
         updater.setUpdateInformation(args["updateInfo"]);
     }
+
+    if (args["noHashCache"]) {
+        updater.setUseHashCache(false);
+    }
+
+    for (const auto& seed : args["seed"].all) {
+        updater.addSeedFile(seed.arg);
+    }
+
+    if (args["seedSiblings"]) {
+        updater.setUseSiblingSeedFiles(true);
+    }
+
+    if (args["measureConnection"]) {
+        updater.setMeasureConnection(true);
+    }
     
     // if the user just wants a description of the AppImage, parse the AppImage, print the description and exit
     if (args["describe"]) {
@@ -185,6 +324,34 @@ int main(const int argc, const char** argv) {
         return 0;
     }
 
+    // the updater notifies us about its progress from a separate thread, the main thread just waits for it to finish
+    std::mutex updateMutex;
+    std::condition_variable updateFinished;
+    bool done = false;
+
+    updater.setStatusMessageCallback([](const std::string& message) {
+        // the progress line is overwritten by the next progress update, so the message needs to go on a new line
+        cout << "\33[2K\r" << message << endl;
+    });
+
+    updater.setProgressCallback([](double progress, long long bytesDone, long long bytesTotal) {
+        cout << "\33[2K\r" << (progress * 100.0f) << "% done";
+        if (bytesTotal >= 0)
+            cout << fixed << setprecision(2) << " (" << bytesDone / 1024.0f / 1024.0f << " of " << bytesTotal / 1024.0f / 1024.0f << " MiB)...";
+        cout << flush;
+    });
+
+    updater.setStateCallback([&updateMutex, &updateFinished, &done](Updater::State state) {
+        if (state != Updater::SUCCESS && state != Updater::ERROR)
+            return;
+
+        // notifying while holding the lock makes sure the main thread cannot destroy the condition variable before
+        // this callback is done with it
+        std::lock_guard<std::mutex> guard(updateMutex);
+        done = true;
+        updateFinished.notify_one();
+    });
+
     // to be fair, this check is not really required (why should this fail), but for the sake of completeness, it's
     // provided here
     if(!updater.start()) {
@@ -194,33 +361,9 @@ int main(const int argc, const char** argv) {
 
     cerr << "Starting update..." << endl;
 
-    while(!updater.isDone()) {
-        this_thread::sleep_for(chrono::milliseconds(100));
-        double progress;
-
-        bool firstMessage = true;
-        std::string nextMessage;
-        while (updater.nextStatusMessage(nextMessage)) {
-            if (firstMessage)
-                cout << endl;
-            firstMessage = false;
-
-            cout << nextMessage << endl;
-        }
-
-        if (!updater.progress(progress))
-            return 1;
-
-        long long fileSize = 0;
-        if (!updater.remoteFileSize(fileSize))
-            fileSize = -1;
-
-        double fileSizeInMiB = fileSize / 1024.0f / 1024.0f;
-
-        cout << "\33[2K\r" << (progress * 100.0f) << "% done";
-        if (fileSize >= 0)
-            cout << fixed << setprecision(2) << " (" << progress * fileSizeInMiB << " of " << fileSizeInMiB << " MiB)...";
-        cout << flush;
+    {
+        std::unique_lock<std::mutex> lock(updateMutex);
+        updateFinished.wait(lock, [&done]() { return done; });
     }
 
     std::string nextMessage;
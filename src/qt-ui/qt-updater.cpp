@@ -14,7 +14,6 @@
 #include <QProgressBar>
 #include <QPushButton>
 #include <QProgressDialog>
-#include <QTimer>
 
 // local headers
 #include "appimage/update/qt-ui.h"
@@ -46,8 +45,6 @@ namespace appimage {
                 QString appName;
                 QString appImageFileName;
 
-                QTimer* progressTimer;
-
                 Spoiler* spoiler;
                 QVBoxLayout* spoilerLayout;
                 QPlainTextEdit* spoilerLog;
@@ -63,7 +60,6 @@ namespace appimage {
                                                                   progressBar(nullptr),
                                                                   mainLayout(nullptr),
                                                                   label(nullptr),
-                                                                  progressTimer(nullptr),
                                                                   progressLabel(nullptr),
                                                                   pathToAppImage(pathToAppImage),
                                                                   spoiler(nullptr),
@@ -105,12 +101,27 @@ namespace appimage {
                     delete buttonBox;
                     delete progressBar;
                     delete mainLayout;
-                    delete progressTimer;
                     delete spoiler;
                 }
 
             public:
-                void startUpdate() {
+                void startUpdate(QtUpdater* self) {
+                    // the callbacks are called from the updater's notifier thread, therefore they must not touch the
+                    // UI directly, but schedule the work in the UI thread
+                    auto scheduleProgressUpdate = [self]() {
+                        QMetaObject::invokeMethod(self, "updateProgress", Qt::QueuedConnection);
+                    };
+
+                    updater->setProgressCallback([scheduleProgressUpdate](double, long long, long long) {
+                        scheduleProgressUpdate();
+                    });
+                    updater->setStateCallback([scheduleProgressUpdate](Updater::State) {
+                        scheduleProgressUpdate();
+                    });
+                    updater->setStatusMessageCallback([self](const std::string& message) {
+                        QMetaObject::invokeMethod(self, "processNewStatusMessage", Qt::QueuedConnection, Q_ARG(std::string, message));
+                    });
+
                     updater->start();
                 }
 
@@ -176,9 +187,8 @@ namespace appimage {
                 connect(d->buttonBox, SIGNAL(rejected()), this, SLOT(showCancelDialog()));
                 layout()->addWidget(d->buttonBox);
 
-                d->progressTimer = new QTimer(this);
-                connect(d->progressTimer, SIGNAL(timeout()), this, SLOT(updateProgress()));
-                d->progressTimer->start(100);
+                // required to pass status messages from the updater's notifier thread to the UI thread
+                qRegisterMetaType<std::string>("std::string");
 
                 adjustSize();
 
@@ -203,6 +213,10 @@ namespace appimage {
             }
 
             void QtUpdater::updateProgress() {
+                // notifications might still be queued when the update has finished already
+                if (d->finished)
+                    return;
+
                 double progress;
 
                 if (!d->updater->progress(progress))
@@ -224,8 +238,6 @@ namespace appimage {
                 if (d->updater->isDone()) {
                     d->finished = true;
 
-                    d->progressTimer->stop();
-
                     auto palette = d->progressBar->palette();
 
                     // can only validate signature once the update has finished, otherwiws
@@ -341,7 +353,7 @@ namespace appimage {
             void QtUpdater::showEvent(QShowEvent* event) {
                 QDialog::showEvent(event);
 
-                d->startUpdate();
+                d->startUpdate(this);
             }
 
             bool QtUpdater::pathToNewFile(QString& pathToNewAppImage) const {
@@ -2,8 +2,10 @@
 #include <cassert>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -13,6 +15,7 @@
 
 // local headers
 #include "signaturevalidator.h"
+#include "util/hashcache.h"
 #include "util/util.h"
 
 namespace appimage::update::signing {
@@ -298,6 +301,10 @@ namespace appimage::update::signing {
 
     SignatureValidationResult::~SignatureValidationResult() = default;
 
+    SignatureValidationResult::SignatureValidationResult(SignatureValidationResult&& other) noexcept = default;
+
+    SignatureValidationResult& SignatureValidationResult::operator=(SignatureValidationResult&& other) noexcept = default;
+
 
     class SignatureValidator::Private {
     public:
@@ -307,7 +314,14 @@ namespace appimage::update::signing {
         // we need a temporary keyring to work with
         std::filesystem::path tempGpgHomeDir;
 
-        explicit Private() {
+        // optional, see constructor documentation
+        std::unique_ptr<HashCache> hashCache = nullptr;
+
+        explicit Private(bool useHashCache) {
+            if (useHashCache) {
+                hashCache = std::make_unique<HashCache>();
+            }
+
             std::string tempGpgHomeDirTemplate = std::filesystem::temp_directory_path() / "appimageupdate-XXXXXX";
             std::vector<char> tempGpgHomeDirCStr(tempGpgHomeDirTemplate.begin(), tempGpgHomeDirTemplate.end());
 
@@ -325,7 +339,14 @@ namespace appimage::update::signing {
                 std::ofstream ofs(tempGpgHomeDir / "keyring");
             }
 
-            context = std::make_unique<GpgmeContext>(tempGpgHomeDir);
+            // validators may be created from different threads, but gpgme's global initialization in the context's
+            // constructor must not run concurrently
+            {
+                static std::mutex contextInitializationMutex;
+                std::lock_guard<std::mutex> guard(contextInitializationMutex);
+
+                context = std::make_unique<GpgmeContext>(tempGpgHomeDir);
+            }
         }
 
         ~Private() noexcept {
@@ -334,12 +355,12 @@ namespace appimage::update::signing {
         }
     };
 
-    SignatureValidator::SignatureValidator() : d(new Private) {}
+    SignatureValidator::SignatureValidator(bool useHashCache) : d(new Private(useHashCache)) {}
 
     SignatureValidationResult SignatureValidator::validate(const UpdatableAppImage& appImage) {
         d->context->importKey(appImage.readSigningKey());
 
-        auto hashData = appImage.calculateHash();
+        auto hashData = d->hashCache != nullptr ? d->hashCache->calculateHash(appImage) : appImage.calculateHash();
         auto signatureData = appImage.readSignature();
         return d->context->validateSignature(hashData, signatureData);
     }
@@ -36,6 +36,9 @@ namespace appimage::update::signing {
         // required to make PImpl work with unique_ptr
         ~SignatureValidationResult() noexcept;
 
+        SignatureValidationResult(SignatureValidationResult&& other) noexcept;
+        SignatureValidationResult& operator=(SignatureValidationResult&& other) noexcept;
+
         ResultType type() const;
         std::string message() const;
         std::vector<std::string> keyFingerprints() const;
@@ -47,7 +50,9 @@ namespace appimage::update::signing {
 
     class SignatureValidator {
     public:
-        explicit SignatureValidator();
+        // if useHashCache is set, the digests of unchanged AppImages are fetched from the persistent HashCache
+        // instead of being recalculated every time
+        explicit SignatureValidator(bool useHashCache = false);
 
         // required to make PImpl work with unique_ptr
         ~SignatureValidator() noexcept;
@@ -23,4 +23,8 @@ namespace appimage::update::updateinformation {
     UpdateInformationType AbstractUpdateInformation::type() const {
         return _type;
     }
+
+    std::vector<std::string> AbstractUpdateInformation::seedFiles(const std::string&) const {
+        return {};
+    }
 }
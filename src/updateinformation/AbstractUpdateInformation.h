@@ -17,6 +17,9 @@ namespace appimage::update::updateinformation {
     protected:
         explicit AbstractUpdateInformation(std::vector<std::string> updateInformationComponents, UpdateInformationType type);
 
+    public:
+        virtual ~AbstractUpdateInformation() = default;
+
     protected:
         // another little helper
         static void assertParameterCount(const std::vector<std::string>& uiComponents, size_t expectedSize);
@@ -24,6 +27,16 @@ namespace appimage::update::updateinformation {
     public:
         [[nodiscard]] UpdateInformationType type() const;
 
+        // human-readable name of the update information type, e.g., shown when describing an AppImage
+        [[nodiscard]] virtual std::string description() const = 0;
+
+        // issued when an update using this update information begins
+        [[nodiscard]] virtual std::string statusMessage() const = 0;
+
         [[nodiscard]] virtual std::string buildUrl(const StatusMessageCallback& issueStatusMessage) const = 0;
+
+        // local files zsync can reuse blocks from in addition to the AppImage, given the URL built by buildUrl()
+        // there are none by default
+        [[nodiscard]] virtual std::vector<std::string> seedFiles(const std::string& zsyncUrl) const;
     };
 }
@@ -15,4 +15,12 @@ namespace appimage::update::updateinformation {
 
         return _updateInformationComponents.back();
     }
+
+    std::string GenericZsyncUpdateInformation::description() const {
+        return "Generic ZSync URL";
+    }
+
+    std::string GenericZsyncUpdateInformation::statusMessage() const {
+        return "Updating from generic server via ZSync";
+    }
 }
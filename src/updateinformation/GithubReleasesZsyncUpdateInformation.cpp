@@ -1,6 +1,222 @@
 #include "GithubReleasesZsyncUpdateInformation.h"
+#include "util/httpcache.h"
 
 namespace appimage::update::updateinformation {
+    namespace {
+        // the newest releases are listed first, therefore a suitable release is usually found on the first page
+        // small pages keep the responses small, and further pages are only fetched if necessary
+        constexpr int releasesPerPage = 10;
+
+        // protects against following an endless chain of pages
+        constexpr int maximumPages = 10;
+
+        struct GithubAsset {
+            std::string name;
+            std::string browserDownloadUrl;
+        };
+
+        // the only fields of a release we are interested in
+        struct GithubRelease {
+            bool prerelease = false;
+            std::string name;
+            std::vector<GithubAsset> assets;
+        };
+
+        /**
+         * SAX handler extracting releases from a GitHub API response, which may be either a single release object,
+         * or a list of releases.
+         *
+         * Release bodies, uploader information and all the other fields are skipped rather than stored in a DOM. For
+         * every release, the callback is called. If it returns false, parsing stops right away.
+         */
+        class GithubReleasesSaxHandler {
+        public:
+            typedef std::function<bool(GithubRelease&& release)> ReleaseCallback;
+
+        private:
+            using json = nlohmann::json;
+
+            // nesting depth of the release objects: 1 for a single release, 2 for a list of releases
+            const size_t _releaseDepth;
+            const ReleaseCallback _callback;
+
+            // one entry per open container: the last key read in it, and whether it is an array
+            std::vector<std::string> _keys;
+            std::vector<bool> _isArray;
+
+            GithubRelease _release;
+            GithubAsset _asset;
+
+            bool _stopped;
+            std::string _error;
+
+        public:
+            GithubReleasesSaxHandler(bool isList, ReleaseCallback callback) : _releaseDepth(isList ? 2 : 1),
+                                                                              _callback(std::move(callback)),
+                                                                              _stopped(false) {}
+
+        private:
+            [[nodiscard]] size_t depth() const {
+                return _keys.size();
+            }
+
+            [[nodiscard]] bool isReleaseObject() const {
+                // in case of a list, the release objects must be contained in the top level array
+                return depth() == _releaseDepth && !_isArray.back() && (_releaseDepth == 1 || _isArray.front());
+            }
+
+            [[nodiscard]] bool isInRelease() const {
+                return depth() >= _releaseDepth && (_releaseDepth == 1 ? !_isArray.front() : _isArray.front());
+            }
+
+            [[nodiscard]] bool isAssetObject() const {
+                return isInRelease() && depth() == _releaseDepth + 2 && !_isArray.back() &&
+                       _keys[_releaseDepth - 1] == "assets";
+            }
+
+            void openContainer(bool isArray) {
+                _keys.emplace_back();
+                _isArray.push_back(isArray);
+            }
+
+            void closeContainer() {
+                _keys.pop_back();
+                _isArray.pop_back();
+            }
+
+        public:
+            [[nodiscard]] bool stopped() const {
+                return _stopped;
+            }
+
+            [[nodiscard]] const std::string& error() const {
+                return _error;
+            }
+
+            bool null() {
+                return true;
+            }
+
+            bool boolean(bool value) {
+                if (isReleaseObject() && _keys.back() == "prerelease") {
+                    _release.prerelease = value;
+                }
+
+                return true;
+            }
+
+            bool number_integer(json::number_integer_t) {
+                return true;
+            }
+
+            bool number_unsigned(json::number_unsigned_t) {
+                return true;
+            }
+
+            bool number_float(json::number_float_t, const json::string_t&) {
+                return true;
+            }
+
+            bool string(json::string_t& value) {
+                if (isReleaseObject() && _keys.back() == "name") {
+                    _release.name = std::move(value);
+                } else if (isAssetObject()) {
+                    if (_keys.back() == "name") {
+                        _asset.name = std::move(value);
+                    } else if (_keys.back() == "browser_download_url") {
+                        _asset.browserDownloadUrl = std::move(value);
+                    }
+                }
+
+                return true;
+            }
+
+            // only available in more recent versions of nlohmann::json, therefore declared as a template
+            template<typename BinaryType>
+            bool binary(BinaryType&) {
+                return true;
+            }
+
+            bool start_object(std::size_t) {
+                openContainer(false);
+
+                if (isReleaseObject()) {
+                    _release = GithubRelease();
+                } else if (isAssetObject()) {
+                    _asset = GithubAsset();
+                }
+
+                return true;
+            }
+
+            bool end_object() {
+                if (isAssetObject()) {
+                    _release.assets.emplace_back(std::move(_asset));
+                } else if (isReleaseObject()) {
+                    if (!_callback(std::move(_release))) {
+                        _stopped = true;
+                        return false;
+                    }
+                }
+
+                closeContainer();
+                return true;
+            }
+
+            bool start_array(std::size_t) {
+                openContainer(true);
+                return true;
+            }
+
+            bool end_array() {
+                closeContainer();
+                return true;
+            }
+
+            bool key(json::string_t& key) {
+                _keys.back() = std::move(key);
+                return true;
+            }
+
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& exception) {
+                _error = exception.what();
+                return false;
+            }
+        };
+
+        // returns the URL of the next page from the Link header (see RFC 8288), or an empty string on the last page
+        // the header looks like this: <https://...?page=2>; rel="next", <https://...?page=5>; rel="last"
+        std::string nextPageUrl(const cpr::Response& response) {
+            const auto it = response.header.find("Link");
+
+            if (it == response.header.end()) {
+                return "";
+            }
+
+            for (const auto& link : util::split(it->second, ',')) {
+                if (link.find("rel=\"next\"") == std::string::npos) {
+                    continue;
+                }
+
+                const auto begin = link.find('<');
+                const auto end = link.find('>', begin);
+
+                if (begin == std::string::npos || end == std::string::npos) {
+                    return "";
+                }
+
+                return link.substr(begin + 1, end - begin - 1);
+            }
+
+            return "";
+        }
+
+        bool hasMatchingAsset(const GithubRelease& release, const std::string& pattern) {
+            return std::any_of(release.assets.begin(), release.assets.end(), [&pattern](const GithubAsset& asset) {
+                return fnmatch(pattern.c_str(), asset.name.c_str(), 0) == 0;
+            });
+        }
+    }
 
     GithubReleasesUpdateInformation::GithubReleasesUpdateInformation(
         const std::vector<std::string>& updateInformationComponents) :
@@ -23,9 +239,7 @@ namespace appimage::update::updateinformation {
         bool usePrereleases = false;
         bool useReleases = true;
 
-        // TODO: this snippet does not support pagination
         // it is more reliable for "known" releases ("latest" and named ones, e.g., "continuous") to query them directly
-        // we expect paginated responses to be very unlikely
         if (tag == "latest-pre") {
             usePrereleases = true;
             useReleases = false;
@@ -43,58 +257,87 @@ namespace appimage::update::updateinformation {
             url << "/tags/" << tag;
         }
 
+        // not ideal, but allows for returning a match for the entire line
+        auto pattern = "*" + filename;
+
         if (parseListResponse) {
             issueStatusMessage("Fetching releases list from GitHub API");
+            url << "?per_page=" << releasesPerPage;
         }
 
-        auto urlStr = url.str();
-        auto response = cpr::Get(cpr::Url{urlStr});
-
-        nlohmann::json json;
+        GithubRelease release;
+        bool found = false;
 
-        try {
-            json = nlohmann::json::parse(response.text);
-        } catch (const std::exception& e) {
-            throw UpdateInformationError(std::string("Failed to parse GitHub response: ") + e.what());
-        }
-        // continue only if request worked
-        if (response.error.code != cpr::ErrorCode::OK || response.status_code < 200 || response.status_code >= 300) {
-            std::ostringstream oss;
-            oss << "GitHub API request failed: HTTP status " << std::to_string(response.status_code)
-                << ", CURL error: " << response.error.message;
-            throw UpdateInformationError(oss.str());
-        }
+        // the responses contain lots of data we do not need (e.g., the release notes), therefore we only extract the
+        // fields we need, and stop parsing as soon as a suitable release has been found
+        // in case of lists, releases which do not provide a matching file yet (e.g., because the upload has not
+        // finished) are skipped
+        const auto releaseCallback = [&](GithubRelease&& item) {
+            if (!(item.prerelease && usePrereleases) && !useReleases) {
+                return true;
+            }
 
-        if (parseListResponse) {
-            bool found = false;
+            if (parseListResponse && !hasMatchingAsset(item, pattern)) {
+                return true;
+            }
 
-            for (auto& item : json) {
-                if (item["prerelease"].get<bool>() && usePrereleases) {
-                    json = item;
-                    found = true;
-                    break;
-                }
+            release = std::move(item);
+            found = true;
+            return false;
+        };
 
-                if (!useReleases) {
-                    continue;
-                }
+        auto pageUrl = url.str();
 
-                json = item;
-                found = true;
+        for (int page = 1; !found && !pageUrl.empty(); ++page) {
+            if (page > maximumPages) {
+                std::ostringstream oss;
+                oss << "Giving up after " << maximumPages << " pages of releases";
+                issueStatusMessage(oss.str());
                 break;
             }
 
-            if (!found) {
-                throw UpdateInformationError(std::string("Failed to find suitable release"));
+            if (page > 1) {
+                issueStatusMessage("Fetching next page of releases list from GitHub API");
+            }
+
+            // conditional requests answered with 304 Not Modified do not count against GitHub's API rate limit
+            auto response = HttpCache().get(pageUrl);
+
+            // continue only if request worked
+            if (response.error.code != cpr::ErrorCode::OK || response.status_code < 200 || response.status_code >= 300) {
+                std::ostringstream oss;
+                oss << "GitHub API request failed: HTTP status " << std::to_string(response.status_code)
+                    << ", CURL error: " << response.error.message;
+                throw UpdateInformationError(oss.str());
+            }
+
+            GithubReleasesSaxHandler handler(parseListResponse, releaseCallback);
+
+            nlohmann::json::sax_parse(response.text, &handler);
+
+            if (!handler.stopped() && !handler.error().empty()) {
+                throw UpdateInformationError(std::string("Failed to parse GitHub response: ") + handler.error());
             }
 
-            issueStatusMessage("Found matching release: " + json["name"].get<std::string>());
+            pageUrl = parseListResponse ? nextPageUrl(response) : "";
         }
 
-        // not ideal, but allows for returning a match for the entire line
-        auto pattern = "*" + filename;
+        if (!found) {
+            if (parseListResponse) {
+                std::ostringstream oss;
+                oss << "Failed to find suitable release. None of the releases provides an artifact matching "
+                    << "the pattern in the update information.";
+                throw UpdateInformationError(oss.str());
+            }
 
-        const auto& assets = json["assets"];
+            throw UpdateInformationError(std::string("Failed to parse GitHub response: no release data found"));
+        }
+
+        if (parseListResponse) {
+            issueStatusMessage("Found matching release: " + release.name);
+        }
+
+        const auto& assets = release.assets;
 
         if (assets.empty()) {
             std::ostringstream oss;
@@ -107,11 +350,8 @@ namespace appimage::update::updateinformation {
         std::vector<std::string> matchingUrls;
 
         for (const auto& asset : assets) {
-            const auto browserDownloadUrl = asset["browser_download_url"].get<std::string>();
-            const auto name = asset["name"].get<std::string>();
-
-            if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
-                matchingUrls.emplace_back(browserDownloadUrl);
+            if (fnmatch(pattern.c_str(), asset.name.c_str(), 0) == 0) {
+                matchingUrls.emplace_back(asset.browserDownloadUrl);
             }
         }
 
@@ -130,4 +370,12 @@ namespace appimage::update::updateinformation {
 
         return matchingUrls[0];
     }
+
+    std::string GithubReleasesUpdateInformation::description() const {
+        return "ZSync via GitHub Releases";
+    }
+
+    std::string GithubReleasesUpdateInformation::statusMessage() const {
+        return "Updating from GitHub Releases via ZSync";
+    }
 }
@@ -18,5 +18,9 @@ namespace appimage::update::updateinformation {
 
     public:
         [[nodiscard]] std::string buildUrl(const StatusMessageCallback& issueStatusMessage) const override;
+
+        [[nodiscard]] std::string description() const override;
+
+        [[nodiscard]] std::string statusMessage() const override;
     };
 }
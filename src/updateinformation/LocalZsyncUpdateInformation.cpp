@@ -0,0 +1,137 @@
+// system headers
+#include <algorithm>
+#include <filesystem>
+#include <fnmatch.h>
+#include <fstream>
+
+// local headers
+#include "LocalZsyncUpdateInformation.h"
+
+namespace appimage::update::updateinformation {
+    namespace {
+        const std::string fileUrlPrefix = "file://";
+        const std::string indexFileName = "index";
+    }
+
+    LocalZsyncUpdateInformation::LocalZsyncUpdateInformation(const std::vector<std::string>& updateInformationComponents) :
+        AbstractUpdateInformation(updateInformationComponents, ZSYNC_LOCAL)
+    {
+        // validation
+        assertParameterCount(_updateInformationComponents, 3);
+
+        _directory = _updateInformationComponents[1];
+        _fileMatchingPattern = _updateInformationComponents[2];
+
+        if (util::stringStartsWith(_directory, fileUrlPrefix)) {
+            _directory = _directory.substr(fileUrlPrefix.size());
+        }
+
+        if (_directory.empty() || _directory[0] != '/') {
+            throw UpdateInformationError("Directory in local-zsync update information must be an absolute path");
+        }
+
+        // strip trailing slashes, except for the root directory
+        while (_directory.size() > 1 && _directory.back() == '/') {
+            _directory.pop_back();
+        }
+    }
+
+    std::vector<std::string> LocalZsyncUpdateInformation::_getAvailableFiles(const StatusMessageCallback& issueStatusMessage) const {
+        const auto matchesPattern = [this](const std::string& fileName) {
+            return fnmatch(_fileMatchingPattern.c_str(), fileName.c_str(), 0) == 0;
+        };
+
+        std::vector<std::string> files;
+
+        const auto indexPath = _directory + "/" + indexFileName;
+        std::ifstream index(indexPath);
+
+        if (index) {
+            issueStatusMessage("Reading index file " + indexPath);
+
+            std::string line;
+
+            while (std::getline(index, line)) {
+                util::trim(line);
+                util::trim(line, '\r');
+
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+
+                // only file names are allowed, the files must be located in the directory itself
+                if (line.find('/') != std::string::npos) {
+                    continue;
+                }
+
+                if (matchesPattern(line)) {
+                    files.emplace_back(line);
+                }
+            }
+
+            return files;
+        }
+
+        std::error_code error;
+        std::filesystem::directory_iterator iterator(_directory, error);
+
+        if (error) {
+            throw UpdateInformationError("Could not read directory " + _directory + ": " + error.message());
+        }
+
+        for (const auto& entry : iterator) {
+            const auto fileName = entry.path().filename().string();
+
+            if (entry.is_regular_file(error) && matchesPattern(fileName)) {
+                files.emplace_back(fileName);
+            }
+        }
+
+        // like for GitHub releases, this relies on the naming pattern used by the AppImage vendors
+        std::sort(files.begin(), files.end());
+
+        return files;
+    }
+
+    std::string LocalZsyncUpdateInformation::buildUrl(const StatusMessageCallback& issueStatusMessage) const {
+        const auto files = _getAvailableFiles(issueStatusMessage);
+
+        // the newest file comes last, but in case its .zsync file is missing (e.g., because the mirror is being
+        // updated right now), we fall back to the previous one
+        for (auto it = files.rbegin(); it != files.rend(); ++it) {
+            const auto appImagePath = _directory + "/" + *it;
+            const auto zsyncPath = appImagePath + ".zsync";
+
+            // the AppImage itself is needed as well, see the class documentation
+            if (util::isFile(zsyncPath) && util::isFile(appImagePath)) {
+                issueStatusMessage("Found matching file in local directory: " + *it);
+                return zsyncPath;
+            }
+        }
+
+        std::ostringstream oss;
+        oss << "Could not find any file matching the pattern in the update information in directory " << _directory
+            << ". Note that every AppImage requires a .zsync file next to it.";
+        throw UpdateInformationError(oss.str());
+    }
+
+    std::string LocalZsyncUpdateInformation::description() const {
+        return "ZSync via local directory";
+    }
+
+    std::string LocalZsyncUpdateInformation::statusMessage() const {
+        return "Updating from local directory via ZSync";
+    }
+
+    std::vector<std::string> LocalZsyncUpdateInformation::seedFiles(const std::string& zsyncUrl) const {
+        // the "URL" is the path of the .zsync file next to the new AppImage, see buildUrl()
+        static const std::string zsyncExtension = ".zsync";
+
+        if (zsyncUrl.size() <= zsyncExtension.size() ||
+            zsyncUrl.compare(zsyncUrl.size() - zsyncExtension.size(), zsyncExtension.size(), zsyncExtension) != 0) {
+            return {};
+        }
+
+        return {zsyncUrl.substr(0, zsyncUrl.size() - zsyncExtension.size())};
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// local headers
+#include "common.h"
+#include "AbstractUpdateInformation.h"
+
+namespace appimage::update::updateinformation {
+    /**
+     * Updates from a local directory, e.g., a mirror on a network filesystem or removable media.
+     *
+     * The "ZSync URL" built from this update information is the plain absolute path of the .zsync file, which zsync2
+     * reads from the filesystem directly. Blocks are not fetched via URLs at all: curl's file:// support cannot serve
+     * the multi-range requests zsync2 issues. Instead, the new AppImage next to the .zsync file (i.e., the .zsync file's
+     * path without the extension) is passed to zsync2 as a seed file, see seedFiles(). As the seed contains every block of the new
+     * file, zsync2 assembles the new file from local data only, and has no blocks left to fetch. Therefore, both the
+     * AppImage and its .zsync file must be present.
+     *
+     * The directory contains the AppImages along with their .zsync files. If it contains a file called "index",
+     * the newest AppImage is picked from it. The index lists the file names of the AppImages, one per line, the newest
+     * one being the last. Lines starting with # are ignored. Without an index, the AppImage whose file name sorts last
+     * is picked.
+     *
+     * format: local-zsync|<absolute path or file:// URL of the directory>|<file name matching pattern>
+     */
+    class LocalZsyncUpdateInformation : public AbstractUpdateInformation {
+    private:
+        std::string _directory;
+        std::string _fileMatchingPattern;
+
+    public:
+        explicit LocalZsyncUpdateInformation(const std::vector<std::string>& updateInformationComponents);
+
+    private:
+        // returns the file names of all AppImages matching the pattern, ordered from oldest to newest
+        [[nodiscard]] std::vector<std::string> _getAvailableFiles(const StatusMessageCallback& issueStatusMessage) const;
+
+    public:
+        [[nodiscard]] std::string buildUrl(const StatusMessageCallback& issueStatusMessage) const override;
+
+        [[nodiscard]] std::string description() const override;
+
+        [[nodiscard]] std::string statusMessage() const override;
+
+        [[nodiscard]] std::vector<std::string> seedFiles(const std::string& zsyncUrl) const override;
+    };
+}
@@ -1,16 +1,85 @@
 // system headers
-#include <regex>
+#include <cctype>
 #include <fnmatch.h>
+#include <string_view>
 
 // library headers
 #include <cpr/cpr.h>
 
 // local headers
 #include "PlingV1UpdateInformation.h"
+#include "util/httpcache.h"
 
 namespace appimage::update::updateinformation {
     namespace {
         const char* plingContentEndpointUrl = "https://api.pling.com/ocs/v1/content/data/";
+
+        // checks whether a tag name suffix like "12>" starts at position, and returns the position after the '>'
+        size_t skipTagNumber(std::string_view text, size_t position) {
+            const auto digitsBegin = position;
+
+            while (position < text.size() && std::isdigit(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+
+            if (position == digitsBegin || position >= text.size() || text[position] != '>') {
+                return std::string_view::npos;
+            }
+
+            return position + 1;
+        }
+
+        // returns the contents of all <downloadlinkN>...</downloadlinkN> elements in the OCS XML response
+        // the text is scanned once, and the returned views point into it, so no copies are made
+        // like the regular expression used previously, an element must not span multiple lines
+        std::vector<std::string_view> findDownloadLinks(std::string_view text) {
+            static constexpr std::string_view openingTag = "<downloadlink";
+            static constexpr std::string_view closingTag = "</downloadlink";
+
+            std::vector<std::string_view> links;
+
+            size_t position = 0;
+
+            while ((position = text.find(openingTag, position)) != std::string_view::npos) {
+                position += openingTag.size();
+
+                const auto contentsBegin = skipTagNumber(text, position);
+
+                if (contentsBegin == std::string_view::npos) {
+                    continue;
+                }
+
+                auto lineEnd = text.find('\n', contentsBegin);
+                if (lineEnd == std::string_view::npos) {
+                    lineEnd = text.size();
+                }
+
+                const auto line = text.substr(0, lineEnd);
+
+                // the first valid closing tag on the same line terminates the element
+                auto contentsEnd = line.find(closingTag, contentsBegin);
+                size_t elementEnd = std::string_view::npos;
+
+                while (contentsEnd != std::string_view::npos) {
+                    elementEnd = skipTagNumber(line, contentsEnd + closingTag.size());
+
+                    if (elementEnd != std::string_view::npos) {
+                        break;
+                    }
+
+                    contentsEnd = line.find(closingTag, contentsEnd + 1);
+                }
+
+                if (contentsEnd == std::string_view::npos) {
+                    continue;
+                }
+
+                links.emplace_back(text.substr(contentsBegin, contentsEnd - contentsBegin));
+                position = elementEnd;
+            }
+
+            return links;
+        }
     }
 
 
@@ -26,25 +95,16 @@ namespace appimage::update::updateinformation {
     std::vector<std::string> PlingV1UpdateInformation::_getAvailableDownloads() const {
         std::vector<std::string> downloads;
 
-        cpr::Url productDetailsUrl = plingContentEndpointUrl + _productId;
-        auto response = cpr::Get(productDetailsUrl);
+        const std::string productDetailsUrl = plingContentEndpointUrl + _productId;
+        auto response = HttpCache().get(productDetailsUrl);
         if (response.status_code >= 200 && response.status_code < 300) {
-            std::regex urlRegex(R"((?:\<downloadlink\d+\>)(.*?)(?:<\/downloadlink\d+\>))");
-
-            std::string text = response.text;
-            std::smatch match;
-
-            // match download link
-            while (std::regex_search(text, match, urlRegex)) {
-                // extract second matched group which contains the actual url
-                std::string url = match[1].str();
+            for (const auto& link : findDownloadLinks(response.text)) {
+                std::string url(link);
 
                 // apply file matching patter to the file name
                 auto fileName = url.substr(url.rfind('/') + 1);
                 if (fnmatch(_fileMatchingPattern.data(), fileName.data(), 0) == 0)
                     downloads.push_back(url);
-
-                text = match.suffix();
             }
         }
 
@@ -84,4 +144,12 @@ namespace appimage::update::updateinformation {
 
         return zsyncUrl;
     }
+
+    std::string PlingV1UpdateInformation::description() const {
+        return "ZSync via OCS";
+    }
+
+    std::string PlingV1UpdateInformation::statusMessage() const {
+        return "Updating from Pling v1 server via ZSync";
+    }
 }
@@ -28,5 +28,9 @@ namespace appimage::update::updateinformation {
         static std::string _resolveZsyncUrl(const std::string& downloadUrl);
 
         [[nodiscard]] std::string buildUrl(const StatusMessageCallback& issueStatusMessage) const override;
+
+        [[nodiscard]] std::string description() const override;
+
+        [[nodiscard]] std::string statusMessage() const override;
     };
 }
@@ -17,6 +17,9 @@ namespace appimage::update::updateinformation {
         ZSYNC_GITHUB_RELEASES = 1,
         // ZSYNC_BINTRAY is deprecated
         ZSYNC_PLING_V1 = 3,
+        ZSYNC_LOCAL = 4,
+        // registered by library users, see appimage/update/updateinformation.h
+        ZSYNC_CUSTOM = 5,
     };
 
     using StatusMessageCallback = std::function<void(const std::string&)>;
@@ -1,9 +1,68 @@
+// system headers
+#include <map>
+#include <mutex>
+
+// local headers
 #include "factory.h"
 #include "GenericZsyncUpdateInformation.h"
 #include "GithubReleasesZsyncUpdateInformation.h"
+#include "LocalZsyncUpdateInformation.h"
 #include "PlingV1UpdateInformation.h"
 
 namespace appimage::update::updateinformation {
+    namespace {
+        template<typename T>
+        UpdateInformationFactory makeFactory() {
+            return [](const std::vector<std::string>& updateInformationComponents) {
+                return std::make_shared<T>(updateInformationComponents);
+            };
+        }
+
+        class UpdateInformationRegistry {
+        private:
+            std::mutex _mutex;
+            std::map<std::string, UpdateInformationFactory> _factories;
+
+        public:
+            UpdateInformationRegistry() {
+                // built-in types
+                _factories["zsync"] = makeFactory<GenericZsyncUpdateInformation>();
+                // TODO: GitHub releases type should consider pre-releases when there's no other types of releases
+                _factories["gh-releases-zsync"] = makeFactory<GithubReleasesUpdateInformation>();
+                _factories["pling-v1-zsync"] = makeFactory<PlingV1UpdateInformation>();
+                _factories["local-zsync"] = makeFactory<LocalZsyncUpdateInformation>();
+            }
+
+        public:
+            static UpdateInformationRegistry& instance() {
+                static UpdateInformationRegistry registry;
+                return registry;
+            }
+
+            void add(const std::string& typeName, UpdateInformationFactory factory) {
+                std::lock_guard<std::mutex> guard(_mutex);
+                _factories[typeName] = std::move(factory);
+            }
+
+            // returns an empty factory if the type is unknown
+            UpdateInformationFactory find(const std::string& typeName) {
+                std::lock_guard<std::mutex> guard(_mutex);
+
+                const auto it = _factories.find(typeName);
+
+                if (it == _factories.end()) {
+                    return {};
+                }
+
+                return it->second;
+            }
+        };
+    }
+
+    void registerUpdateInformationType(const std::string& typeName, UpdateInformationFactory factory) {
+        UpdateInformationRegistry::instance().add(typeName, std::move(factory));
+    }
+
     std::shared_ptr<AbstractUpdateInformation> makeUpdateInformation(const std::string& rawUpdateInformation) {
         const auto updateInformationComponents = splitRawUpdateInformationComponents(rawUpdateInformation);
 
@@ -11,15 +70,12 @@ namespace appimage::update::updateinformation {
             throw UpdateInformationError("Update information invalid: | not found");
         }
 
-        if (updateInformationComponents[0] == "zsync") {
-            return std::make_shared<GenericZsyncUpdateInformation>(updateInformationComponents);
-        } else if (updateInformationComponents[0] == "gh-releases-zsync") {
-            // TODO: GitHub releases type should consider pre-releases when there's no other types of releases
-            return std::make_shared<GithubReleasesUpdateInformation>(updateInformationComponents);
-        } else if (updateInformationComponents[0] == "pling-v1-zsync") {
-            return std::make_shared<PlingV1UpdateInformation>(updateInformationComponents);
+        const auto factory = UpdateInformationRegistry::instance().find(updateInformationComponents[0]);
+
+        if (!factory) {
+            throw UpdateInformationError("Unknown update information type: " + updateInformationComponents[0]);
         }
 
-        throw UpdateInformationError("Unknown update information type: " + updateInformationComponents[0]);
+        return factory(updateInformationComponents);
     }
 }
@@ -3,10 +3,18 @@
 #include "AbstractUpdateInformation.h"
 
 // system headers
+#include <functional>
 #include <memory>
 
 namespace appimage::update::updateinformation {
     typedef std::shared_ptr<AbstractUpdateInformation> UpdateInformationPtr;
 
+    // creates update information from the components of the raw update information (the first one being the type name)
+    typedef std::function<UpdateInformationPtr(const std::vector<std::string>& updateInformationComponents)> UpdateInformationFactory;
+
+    // registers a factory for the given type name (i.e., the first component of the raw update information)
+    // replaces any factory registered for the same type name previously, including the built-in ones
+    void registerUpdateInformationType(const std::string& typeName, UpdateInformationFactory factory);
+
     UpdateInformationPtr makeUpdateInformation(const std::string& rawUpdateInformation);
 }
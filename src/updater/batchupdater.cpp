@@ -0,0 +1,478 @@
+// system headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// local headers
+#include "appimage/update/batch.h"
+#include "util/updatableappimage.h"
+#include "util/util.h"
+
+// convenience declaration
+namespace {
+    typedef std::lock_guard<std::mutex> lock_guard;
+
+    // C++17 does not provide semaphores yet
+    class Semaphore {
+    private:
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        unsigned int _available;
+
+    public:
+        explicit Semaphore(unsigned int count) : _available(count) {}
+
+    public:
+        void acquire() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _available > 0; });
+            --_available;
+        }
+
+        void release() {
+            {
+                lock_guard guard(_mutex);
+                ++_available;
+            }
+
+            _condition.notify_one();
+        }
+    };
+
+    class SemaphoreGuard {
+    private:
+        Semaphore& _semaphore;
+
+    public:
+        explicit SemaphoreGuard(Semaphore& semaphore) : _semaphore(semaphore) {
+            _semaphore.acquire();
+        }
+
+        ~SemaphoreGuard() {
+            _semaphore.release();
+        }
+
+        SemaphoreGuard(const SemaphoreGuard&) = delete;
+        SemaphoreGuard& operator=(const SemaphoreGuard&) = delete;
+    };
+
+    bool endsWith(const std::string& string, const std::string& suffix) {
+        return string.size() >= suffix.size() && string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+namespace appimage::update {
+    using namespace util;
+
+    class BatchUpdater::Private {
+    public:
+        Private(std::vector<std::string> pathsToAppImages, bool overwrite) : pathsToAppImages(std::move(pathsToAppImages)),
+            overwrite(overwrite),
+            jobs(4),
+            networkJobs(0),
+            diskJobs(0),
+            checkOnly(false),
+            removeOldFiles(false),
+            useSiblingSeedFiles(false),
+            useHashCache(true),
+            measureConnection(false)
+        {};
+
+    public:
+        const std::vector<std::string> pathsToAppImages;
+        const bool overwrite;
+
+        unsigned int jobs;
+
+        // 0 means "same as jobs"
+        unsigned int networkJobs;
+        unsigned int diskJobs;
+
+        bool checkOnly;
+        bool removeOldFiles;
+        std::vector<std::string> seedFiles;
+        bool useSiblingSeedFiles;
+        bool useHashCache;
+        bool measureConnection;
+
+        ResultCallback resultCallback;
+        std::mutex resultCallbackMutex;
+
+    public:
+        static void fetchStatusMessages(Updater& updater, Result& result) {
+            std::string message;
+
+            while (updater.nextStatusMessage(message)) {
+                result.statusMessages.emplace_back(message);
+            }
+        }
+
+        // blocks until the update run by the given updater has finished
+        static void waitForUpdate(Updater& updater) {
+            std::mutex mutex;
+            std::condition_variable condition;
+            bool done = false;
+
+            updater.setStateCallback([&mutex, &condition, &done](Updater::State state) {
+                if (state != Updater::SUCCESS && state != Updater::ERROR)
+                    return;
+
+                // notifying while holding the lock makes sure the waiting thread cannot destroy the condition variable
+                // before this callback is done with it
+                lock_guard guard(mutex);
+                done = true;
+                condition.notify_one();
+            });
+
+            if (!updater.start()) {
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&done]() { return done; });
+        }
+
+        void processAppImage(
+            const std::string& pathToAppImage,
+            const std::vector<std::string>& siblingSeedFiles,
+            Result& result,
+            Semaphore& networkSlots,
+            Semaphore& diskSlots
+        ) {
+            result.pathToAppImage = pathToAppImage;
+
+            Updater updater(pathToAppImage, overwrite);
+            updater.setUseHashCache(useHashCache);
+            updater.setMeasureConnection(measureConnection);
+
+            // the batch selects the siblings itself, see findSiblingSeedFiles()
+            updater.setUseSiblingSeedFiles(false);
+
+            for (const auto& seedFile : seedFiles) {
+                updater.addSeedFile(seedFile);
+            }
+
+            for (const auto& seedFile : siblingSeedFiles) {
+                updater.addSeedFile(seedFile);
+            }
+
+            bool updateAvailable = true;
+            bool checkSuccessful;
+
+            {
+                SemaphoreGuard networkGuard(networkSlots);
+                checkSuccessful = updater.checkForChanges(updateAvailable);
+            }
+
+            fetchStatusMessages(updater, result);
+
+            if (!checkSuccessful) {
+                result.status = STATUS_FAILED;
+                result.message = "Update check failed";
+                return;
+            }
+
+            if (!updateAvailable) {
+                result.status = STATUS_UP_TO_DATE;
+                result.message = "Up to date";
+                return;
+            }
+
+            if (checkOnly) {
+                result.status = STATUS_UPDATE_AVAILABLE;
+                result.message = "Update available";
+                return;
+            }
+
+            // the update writes the new file while downloading, therefore it requires both kinds of slots
+            // they are always acquired in the same order, which prevents deadlocks
+            {
+                SemaphoreGuard networkGuard(networkSlots);
+                SemaphoreGuard diskGuard(diskSlots);
+                waitForUpdate(updater);
+            }
+
+            fetchStatusMessages(updater, result);
+
+            if (updater.hasError() || !updater.pathToNewFile(result.pathToNewFile)) {
+                result.status = STATUS_FAILED;
+                result.message = "Update failed";
+                return;
+            }
+
+            // normalize against pathToAppImage - so they follow the same format
+            result.pathToNewFile = abspath(result.pathToNewFile);
+
+            {
+                // validating the signatures requires calculating the digests of both the old and the new file
+                SemaphoreGuard diskGuard(diskSlots);
+                result.validationState = updater.validateSignature();
+            }
+
+            fetchStatusMessages(updater, result);
+
+            if (result.validationState >= Updater::VALIDATION_FAILED) {
+                // validation failed, restore original file to prevent bad things from happening
+                updater.restoreOriginalFile();
+
+                result.status = STATUS_FAILED;
+                result.message = "Validation error: " + Updater::signatureValidationMessage(result.validationState) +
+                                 ", restored original file";
+                return;
+            }
+
+            // copy permissions of the old AppImage to the new version
+            updater.copyPermissionsToNewFile();
+
+            if (removeOldFiles) {
+                const auto oldFilePath = pathToOldAppImage(abspath(pathToAppImage), result.pathToNewFile);
+
+                if (isFile(oldFilePath)) {
+                    unlink(oldFilePath.c_str());
+                }
+            }
+
+            result.status = STATUS_UPDATED;
+            result.message = "Updated";
+
+            if (result.validationState >= Updater::VALIDATION_WARNING) {
+                result.message += " (validation warning: " + Updater::signatureValidationMessage(result.validationState) + ")";
+            }
+        }
+
+        void notifyResult(const Result& result) {
+            lock_guard guard(resultCallbackMutex);
+
+            if (resultCallback) {
+                resultCallback(result);
+            }
+        }
+
+        // AppImages with the same update information (e.g., several versions of the same application in one
+        // directory) resolve to the same .zsync file, and thus to the same output file
+        // updating them concurrently would have them write to the same partial output and rename the same files,
+        // therefore they are grouped, and the AppImages within a group are processed one after another
+        std::vector<std::vector<std::size_t>> groupByUpdateTarget() const {
+            std::vector<std::vector<std::size_t>> groups;
+            std::map<std::string, std::size_t> groupIndices;
+
+            for (std::size_t index = 0; index < pathsToAppImages.size(); ++index) {
+                std::string rawUpdateInformation;
+
+                try {
+                    rawUpdateInformation = UpdatableAppImage(pathsToAppImages[index]).readRawUpdateInformation();
+                } catch (const std::exception&) {
+                    // the update will fail anyway, and report the error properly
+                }
+
+                if (!rawUpdateInformation.empty()) {
+                    const auto it = groupIndices.find(rawUpdateInformation);
+
+                    if (it != groupIndices.end()) {
+                        groups[it->second].emplace_back(index);
+                        continue;
+                    }
+
+                    groupIndices[rawUpdateInformation] = groups.size();
+                }
+
+                groups.push_back({index});
+            }
+
+            return groups;
+        }
+
+        // looks for sibling seed files once per directory, rather than once per AppImage, which would require parsing
+        // every file in the directory over and over again
+        // AppImages processed by other groups might be replaced by their updates at any time, so they are not
+        // considered; within a group, AppImages are processed one after another, so they can be used safely
+        std::vector<std::vector<std::string>> findSiblingSeedFiles(const std::vector<std::vector<std::size_t>>& groups) const {
+            std::vector<std::vector<std::string>> siblingSeedFiles(pathsToAppImages.size());
+
+            if (!useSiblingSeedFiles)
+                return siblingSeedFiles;
+
+            std::map<std::string, std::size_t> groupOfPath;
+
+            for (std::size_t groupIndex = 0; groupIndex < groups.size(); ++groupIndex) {
+                for (const auto index : groups[groupIndex]) {
+                    groupOfPath[abspath(pathsToAppImages[index])] = groupIndex;
+                }
+            }
+
+            std::map<std::string, std::vector<std::string>> candidatesInDirectory;
+
+            for (std::size_t groupIndex = 0; groupIndex < groups.size(); ++groupIndex) {
+                for (const auto index : groups[groupIndex]) {
+                    const auto appImagePath = abspath(pathsToAppImages[index]);
+                    const auto directory = std::filesystem::path(appImagePath).parent_path().string();
+
+                    if (candidatesInDirectory.find(directory) == candidatesInDirectory.end()) {
+                        try {
+                            candidatesInDirectory[directory] = BatchUpdater::findAppImages(directory);
+                        } catch (const std::invalid_argument&) {
+                            // not being able to use seed files is not an error
+                            candidatesInDirectory[directory] = {};
+                        }
+                    }
+
+                    std::vector<std::string> candidates;
+
+                    for (const auto& candidate : candidatesInDirectory[directory]) {
+                        const auto it = groupOfPath.find(candidate);
+
+                        if (it == groupOfPath.end() || it->second == groupIndex) {
+                            candidates.emplace_back(candidate);
+                        }
+                    }
+
+                    siblingSeedFiles[index] = selectSiblingSeedFiles(appImagePath, candidates);
+                }
+            }
+
+            return siblingSeedFiles;
+        }
+
+        std::vector<Result> run() {
+            std::vector<Result> results(pathsToAppImages.size());
+
+            const auto groups = groupByUpdateTarget();
+            const auto siblingSeedFiles = findSiblingSeedFiles(groups);
+
+            const auto workerCount = std::max(1u, std::min<unsigned int>(jobs, groups.size()));
+            Semaphore networkSlots(std::max(1u, networkJobs > 0 ? networkJobs : jobs));
+            Semaphore diskSlots(std::max(1u, diskJobs > 0 ? diskJobs : jobs));
+
+            // the workers pick the next group of AppImages to process from the list until all of them have been handled
+            std::atomic<std::size_t> nextGroup(0);
+
+            const auto worker = [this, &results, &groups, &siblingSeedFiles, &nextGroup, &networkSlots, &diskSlots]() {
+                while (true) {
+                    const auto groupIndex = nextGroup++;
+
+                    if (groupIndex >= groups.size())
+                        return;
+
+                    for (const auto index : groups[groupIndex]) {
+                        auto& result = results[index];
+
+                        try {
+                            processAppImage(pathsToAppImages[index], siblingSeedFiles[index], result, networkSlots, diskSlots);
+                        } catch (const std::exception& e) {
+                            result.status = STATUS_FAILED;
+                            result.message = e.what();
+                        }
+
+                        notifyResult(result);
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(workerCount);
+
+            for (unsigned int i = 0; i < workerCount; ++i) {
+                workers.emplace_back(worker);
+            }
+
+            for (auto& thread : workers) {
+                thread.join();
+            }
+
+            return results;
+        }
+    };
+
+    BatchUpdater::BatchUpdater(std::vector<std::string> pathsToAppImages, bool overwrite) : d(new Private(std::move(pathsToAppImages), overwrite)) {}
+
+    BatchUpdater::~BatchUpdater() = default;
+
+    std::vector<std::string> BatchUpdater::findAppImages(const std::string& directory) {
+        std::error_code error;
+        std::filesystem::directory_iterator iterator(directory, error);
+
+        if (error) {
+            throw std::invalid_argument("Could not read directory: " + directory + ": " + error.message());
+        }
+
+        std::vector<std::string> paths;
+
+        for (const auto& entry : iterator) {
+            const auto name = entry.path().filename().string();
+
+            // leftovers of previous updates are AppImages, too, but must not be updated
+            if (endsWith(name, ".zs-old") || endsWith(name, ".part") || endsWith(name, ".resume"))
+                continue;
+
+            const auto path = abspath(entry.path().string());
+
+            if (!isFile(path))
+                continue;
+
+            try {
+                const auto type = UpdatableAppImage(path).appImageType();
+
+                if (type == 1 || type == 2)
+                    paths.emplace_back(path);
+            } catch (const std::exception&) {
+                // not an AppImage
+            }
+        }
+
+        std::sort(paths.begin(), paths.end());
+
+        return paths;
+    }
+
+    void BatchUpdater::setJobs(unsigned int jobs) {
+        d->jobs = jobs;
+    }
+
+    void BatchUpdater::setNetworkJobs(unsigned int networkJobs) {
+        d->networkJobs = networkJobs;
+    }
+
+    void BatchUpdater::setDiskJobs(unsigned int diskJobs) {
+        d->diskJobs = diskJobs;
+    }
+
+    void BatchUpdater::setCheckOnly(bool checkOnly) {
+        d->checkOnly = checkOnly;
+    }
+
+    void BatchUpdater::setRemoveOldFiles(bool removeOldFiles) {
+        d->removeOldFiles = removeOldFiles;
+    }
+
+    void BatchUpdater::addSeedFile(const std::string& path) {
+        d->seedFiles.emplace_back(path);
+    }
+
+    void BatchUpdater::setUseSiblingSeedFiles(bool useSiblingSeedFiles) {
+        d->useSiblingSeedFiles = useSiblingSeedFiles;
+    }
+
+    void BatchUpdater::setUseHashCache(bool useHashCache) {
+        d->useHashCache = useHashCache;
+    }
+
+    void BatchUpdater::setMeasureConnection(bool measureConnection) {
+        d->measureConnection = measureConnection;
+    }
+
+    void BatchUpdater::setResultCallback(ResultCallback callback) {
+        d->resultCallback = std::move(callback);
+    }
+
+    std::vector<BatchUpdater::Result> BatchUpdater::run() {
+        return d->run();
+    }
+}
@@ -0,0 +1,62 @@
+// system headers
+#include <exception>
+#include <memory>
+
+// local headers
+#include "appimage/update/updateinformation.h"
+#include "updateinformation/updateinformation.h"
+
+namespace appimage::update {
+    using namespace updateinformation;
+
+    namespace {
+        // adapts resolvers registered by library users to the interface used internally
+        class CustomUpdateInformation : public AbstractUpdateInformation {
+        private:
+            std::string _description;
+            UpdateInformationResolver _resolver;
+
+        public:
+            CustomUpdateInformation(
+                const std::vector<std::string>& updateInformationComponents,
+                std::string description,
+                UpdateInformationResolver resolver
+            ) : AbstractUpdateInformation(updateInformationComponents, ZSYNC_CUSTOM),
+                _description(std::move(description)),
+                _resolver(std::move(resolver)) {}
+
+        public:
+            [[nodiscard]] std::string description() const override {
+                return _description;
+            }
+
+            [[nodiscard]] std::string statusMessage() const override {
+                return "Updating via ZSync (" + _description + ")";
+            }
+
+            [[nodiscard]] std::string buildUrl(const StatusMessageCallback& issueStatusMessage) const override {
+                // the updater expects errors in the update information to be reported as UpdateInformationError
+                try {
+                    return _resolver(_updateInformationComponents, issueStatusMessage);
+                } catch (const UpdateInformationError&) {
+                    throw;
+                } catch (const std::exception& e) {
+                    throw UpdateInformationError(e.what());
+                }
+            }
+        };
+    }
+
+    void registerUpdateInformationType(
+        const std::string& typeName,
+        const std::string& description,
+        UpdateInformationResolver resolver
+    ) {
+        updateinformation::registerUpdateInformationType(
+            typeName,
+            [description, resolver](const std::vector<std::string>& updateInformationComponents) {
+                return std::make_shared<CustomUpdateInformation>(updateInformationComponents, description, resolver);
+            }
+        );
+    }
+}
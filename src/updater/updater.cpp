@@ -1,13 +1,21 @@
 // system headers
 #include <cstring>
-#include <deque>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <libgen.h>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
 #include <unistd.h>
 
 // library headers
@@ -17,8 +25,13 @@
 
 // local headers
 #include "appimage/update.h"
+#include "appimage/update/batch.h"
 #include "signing/signaturevalidator.h"
 #include "updateinformation/updateinformation.h"
+#include "util/hashcache.h"
+#include "util/httpsession.h"
+#include "util/resumejournal.h"
+#include "util/statusmessagequeue.h"
 #include "util/updatableappimage.h"
 #include "util/util.h"
 #include "zsutil.h"
@@ -26,6 +39,13 @@
 // convenience declaration
 namespace {
     typedef std::lock_guard<std::mutex> lock_guard;
+
+    // zsync merges ranges separated by gaps smaller than this threshold into a single request
+    // used whenever the connection could not be measured
+    constexpr unsigned long defaultRangesOptimizationThreshold = 64 * 4096;
+
+    // amount of data fetched to estimate the throughput of the connection
+    constexpr long probeSize = 256 * 1024;
 }
 
 namespace appimage::update {
@@ -35,13 +55,46 @@ namespace appimage::update {
 
     class Updater::Private {
     public:
-        explicit Private(const std::string& pathToAppImage) : state(INITIALIZED),
-            appImage(pathToAppImage),
+        // outcome of the signature validation of the original AppImage
+        struct OldAppImageValidation {
+            bool isSigned = false;
+
+            // only available if the AppImage is signed
+            std::shared_ptr<SignatureValidationResult> result;
+        };
+
+        // ZSync URL, along with what the update information it has been built from provides for the update
+        struct ResolvedZsyncUrl {
+            std::string url;
+            std::string statusMessage;
+            std::vector<std::string> seedFiles;
+        };
+
+    public:
+        explicit Private(const std::string& pathToAppImage) : appImage(pathToAppImage),
+            rawUpdateInformation(appImage.readRawUpdateInformation()),
+            state(INITIALIZED),
             zSyncClient(nullptr),
             thread(nullptr),
             mutex(),
+            reportedDroppedStatusMessages(0),
             overwrite(false),
-            rawUpdateInformation(appImage.readRawUpdateInformation())
+            useHashCache(true),
+            useSiblingSeedFiles(false),
+            minimumRangesOptimizationThreshold(16 * 1024),
+            maximumRangesOptimizationThreshold(4 * 1024 * 1024),
+            measureConnection(false),
+            rangesOptimizationThreshold(0),
+            stopRequested(false),
+            orphaned(false),
+            callbackInterval(100),
+            notifierThread(nullptr),
+            notifierActive(false),
+            notifierWakeUp(false),
+            updateFinished(false),
+            callbacksEnabled(true),
+            lastNotifiedState(INITIALIZED),
+            lastNotifiedProgress(-1)
         {};
 
     public:
@@ -51,32 +104,503 @@ namespace appimage::update {
         // UpdateInformation infrastructure
         std::string rawUpdateInformation;
 
+        // building the ZSync URL may require API requests (e.g., for GitHub releases), therefore it is done only once
+        // per update information
+        // both fields are protected by resolveMutex
+        std::optional<ResolvedZsyncUrl> resolvedZsyncUrl;
+        std::mutex resolveMutex;
+
         // state
         State state;
 
         // ZSync client -- will be instantiated only if necessary
         std::shared_ptr<zsync2::ZSyncClient> zSyncClient;
 
+        // URL the running update downloads from, used to identify partial output to resume from
+        std::string resumedZsyncUrl;
+
         // threading
         std::thread* thread;
         std::mutex mutex;
 
         // status messages
-        std::deque<std::string> statusMessages;
+        // written to by the update thread as well as the caller's thread
+        StatusMessageQueue statusMessages;
+        unsigned long long reportedDroppedStatusMessages;
 
         // defines whether to overwrite original file
         bool overwrite;
 
+        // defines whether signature validation may use the persistent hash cache
+        bool useHashCache;
+
+        // additional files zsync may reuse blocks from
+        std::vector<std::string> seedFiles;
+        bool useSiblingSeedFiles;
+
+        // bounds for the ranges optimization threshold, which is chosen based on the measured connection if
+        // measureConnection is set
+        unsigned long minimumRangesOptimizationThreshold;
+        unsigned long maximumRangesOptimizationThreshold;
+        bool measureConnection;
+
+        // the threshold chosen for the update, 0 until it has been chosen
+        std::atomic<unsigned long> rangesOptimizationThreshold;
+
+        // the original AppImage does not change during the update, so it is validated in the background while
+        // the update is running
+        std::shared_future<OldAppImageValidation> oldAppImageValidation;
+
+        // set by stop(), checked by the update thread between the phases of the update
+        std::atomic<bool> stopRequested;
+
+        // set when the Updater is destroyed while the update thread is still running
+        // in that case, the thread takes over the ownership of this instance, and deletes it once it has finished
+        bool orphaned;
+
+        // callbacks, set by the user before the update is started
+        ProgressCallback progressCallback;
+        StateCallback stateCallback;
+        StatusMessageCallback statusMessageCallback;
+        std::chrono::milliseconds callbackInterval;
+
+        // the notifier thread polls the ZSync client, and calls the callbacks
+        // it is started along with the update thread if any callback is set, and joined by the update thread
+        // notifierThread is only accessed by start() before the update thread is created, and by the update thread
+        std::thread* notifierThread;
+        std::atomic<bool> notifierActive;
+        std::mutex notifierMutex;
+        std::condition_variable notifierCondition;
+        bool notifierWakeUp;
+        bool updateFinished;
+
+        // held while callbacks are called, allows the destructor to disable them safely
+        std::mutex callbackMutex;
+        bool callbacksEnabled;
+
+        // used by the notifier thread only
+        State lastNotifiedState;
+        double lastNotifiedProgress;
+        std::chrono::steady_clock::time_point lastProgressNotification;
+
     public:
+        static OldAppImageValidation validateOldAppImage(const UpdatableAppImage& oldAppImage, bool useHashCache) {
+            OldAppImageValidation validation;
+
+            validation.isSigned = !oldAppImage.readSignature().empty();
+
+            if (validation.isSigned) {
+                SignatureValidator validator(useHashCache);
+                validation.result = std::make_shared<SignatureValidationResult>(validator.validate(oldAppImage));
+            }
+
+            return validation;
+        }
+
+        void startOldAppImageValidation() {
+            // the copy shares the metadata parsed during construction, including the open file descriptor
+            // therefore, the validation is not affected by the update replacing the file on disk
+            const auto oldAppImage = appImage;
+
+            oldAppImageValidation = std::async(std::launch::async, &Private::validateOldAppImage, oldAppImage, useHashCache).share();
+        }
+
         void issueStatusMessage(const std::string& message) {
-            statusMessages.push_back(message);
+            statusMessages.push(message);
+            wakeNotifier();
+        }
+
+        // must be called with the mutex locked
+        void setState(State newState) {
+            state = newState;
+            wakeNotifier();
+        }
+
+        // must be called with the mutex locked
+        bool progress(double& progress) {
+            if (state == INITIALIZED) {
+                // this protects update checks from returning progress, which would only occur when using method 0
+                progress = 0;
+                return true;
+            } else if (state == SUCCESS || state == ERROR) {
+                progress = 1;
+                return true;
+            }
+
+            if (zSyncClient != nullptr) {
+                progress = zSyncClient->progress();
+                return true;
+            }
+
+            // update information is still being resolved, there is no progress to report yet
+            progress = 0;
+            return false;
+        }
+
+        // must be called with the mutex locked
+        bool nextStatusMessage(std::string& message) {
+            // let the user know if messages got lost because nobody fetched them in time
+            const auto droppedStatusMessages = statusMessages.droppedCount();
+            if (droppedStatusMessages != reportedDroppedStatusMessages) {
+                std::ostringstream oss;
+                oss << (droppedStatusMessages - reportedDroppedStatusMessages) << " status message(s) dropped";
+                message = oss.str();
+                reportedDroppedStatusMessages = droppedStatusMessages;
+                return true;
+            }
+
+            // first, check own message queue
+            if (statusMessages.pop(message)) {
+                return true;
+            }
+
+            // next, check zsync client for a message
+            if (zSyncClient != nullptr) {
+                std::string zsyncMessage;
+                if (!zSyncClient->nextStatusMessage(zsyncMessage))
+                    return false;
+                // show that the message is coming from zsync2
+                message = "zsync2: " + zsyncMessage;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool hasCallbacks() const {
+            return progressCallback || stateCallback || statusMessageCallback;
+        }
+
+        // may be called from any thread, also while stopNotifier() tears down the notifier thread
+        // therefore, notifierThread must not be accessed here; waking up a notifier which is not running is harmless
+        void wakeNotifier() {
+            {
+                lock_guard guard(notifierMutex);
+                notifierWakeUp = true;
+            }
+
+            notifierCondition.notify_one();
+        }
+
+        void startNotifier() {
+            notifierActive = true;
+            notifierThread = new std::thread(&Private::runNotifier, this);
+        }
+
+        void stopNotifier() {
+            if (notifierThread == nullptr)
+                return;
+
+            {
+                lock_guard guard(notifierMutex);
+                updateFinished = true;
+            }
+
+            notifierCondition.notify_one();
+
+            notifierThread->join();
+            delete notifierThread;
+            notifierThread = nullptr;
+        }
+
+        // notifier thread runner
+        void runNotifier() {
+            while (true) {
+                bool finished;
+
+                {
+                    std::unique_lock<std::mutex> lock(notifierMutex);
+                    notifierCondition.wait_for(lock, callbackInterval, [this]() {
+                        return notifierWakeUp || updateFinished;
+                    });
+
+                    notifierWakeUp = false;
+                    finished = updateFinished;
+                }
+
+                notifyCallbacks(finished);
+
+                if (finished)
+                    break;
+            }
+        }
+
+        void notifyCallbacks(bool finished) {
+            State currentState;
+            double currentProgress = 0;
+            long long fileSize = -1;
+            std::vector<std::string> messages;
+
+            {
+                lock_guard guard(mutex);
+
+                currentState = state;
+                progress(currentProgress);
+
+                if (zSyncClient == nullptr || !zSyncClient->remoteFileSize(fileSize))
+                    fileSize = -1;
+
+                // the messages must be fetched after the state, so they are delivered before the final state
+                if (statusMessageCallback && notifierActive) {
+                    std::string message;
+                    while (nextStatusMessage(message))
+                        messages.emplace_back(message);
+                }
+
+                // once the update has finished, the messages issued afterwards (e.g., during the signature validation)
+                // are available via nextStatusMessage() again
+                if (currentState == SUCCESS || currentState == ERROR)
+                    notifierActive = false;
+            }
+
+            // the callbacks are called without holding the mutex, allowing them to call the Updater's methods
+            lock_guard guard(callbackMutex);
+
+            if (!callbacksEnabled)
+                return;
+
+            for (const auto& message : messages) {
+                statusMessageCallback(message);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const bool stateChanged = currentState != lastNotifiedState;
+
+            if (progressCallback && currentProgress != lastNotifiedProgress) {
+                // progress notifications are rate limited, except for the last one
+                if (stateChanged || finished || now - lastProgressNotification >= callbackInterval) {
+                    const long long bytesDone = fileSize < 0 ? -1 : static_cast<long long>(currentProgress * fileSize);
+                    progressCallback(currentProgress, bytesDone, fileSize);
+
+                    lastNotifiedProgress = currentProgress;
+                    lastProgressNotification = now;
+                }
+            }
+
+            if (stateCallback && stateChanged) {
+                stateCallback(currentState);
+            }
+
+            lastNotifiedState = currentState;
         }
 
         StatusMessageCallback makeIssueStatusMessageCallback() {
             return [this](const std::string& message) {issueStatusMessage(message);};
         }
 
-        void validateAppImage() {
+        // measures the bandwidth-delay product of the connection to the server hosting the given URL in bytes
+        // the connection is measured with a few requests for the .zsync file, which is hosted alongside the file to
+        // download in most cases
+        // successful measurements are cached per host for the lifetime of the process, so that, e.g., a batch of
+        // updates from the same server measures the connection only once
+        std::optional<double> measureBandwidthDelayProduct(const std::string& zsyncUrl) {
+            static std::mutex cacheMutex;
+            static std::map<std::string, double> cachedMeasurements;
+
+            const auto hostBegin = zsyncUrl.find("://") + 3;
+            const auto host = zsyncUrl.substr(0, zsyncUrl.find('/', hostBegin));
+
+            {
+                lock_guard guard(cacheMutex);
+
+                const auto it = cachedMeasurements.find(host);
+                if (it != cachedMeasurements.end())
+                    return it->second;
+            }
+
+            // a dedicated session makes sure all requests share a connection, so that the connection setup is
+            // excluded from the measurements
+            cpr::Session session;
+            session.SetHttpVersion(cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS});
+
+            // the first request establishes the connection, and follows redirects (e.g., GitHub redirects to its
+            // CDN), the following ones are sent to the final URL directly, so no redirect adds to their timings
+            session.SetUrl(cpr::Url{zsyncUrl});
+            const auto connectionProbe = session.Head();
+            if (connectionProbe.status_code != 200)
+                return std::nullopt;
+
+            session.SetUrl(connectionProbe.url);
+
+            const auto rttProbe = session.Head();
+            if (rttProbe.status_code != 200 || rttProbe.elapsed <= 0)
+                return std::nullopt;
+
+            const auto roundTripTime = rttProbe.elapsed;
+
+            // the transfer is aborted once enough data has been received, in case the server ignores the range
+            long bytesReceived = 0;
+            session.SetHeader(cpr::Header{{"Range", "bytes=0-" + std::to_string(probeSize - 1)}});
+            session.SetWriteCallback(cpr::WriteCallback{[&bytesReceived](const std::string& data, auto&&...) {
+                bytesReceived += static_cast<long>(data.size());
+                return bytesReceived < probeSize;
+            }});
+
+            const auto throughputProbe = session.Get();
+
+            // a server ignoring the range would have sent the entire file, the timings of the aborted transfer are
+            // not representative
+            if (throughputProbe.status_code != 206)
+                return std::nullopt;
+
+            const auto transferTime = throughputProbe.elapsed - roundTripTime;
+
+            // small .zsync files are transferred too quickly to yield meaningful results
+            if (bytesReceived < probeSize / 4 || transferTime <= 0)
+                return std::nullopt;
+
+            const auto bytesPerSecond = static_cast<double>(bytesReceived) / transferTime;
+
+            std::ostringstream oss;
+            oss << "Measured round trip time " << static_cast<long>(roundTripTime * 1000) << " ms, throughput "
+                << static_cast<long>(bytesPerSecond / 1024) << " kiB/s";
+            issueStatusMessage(oss.str());
+
+            const auto bandwidthDelayProduct = bytesPerSecond * roundTripTime;
+
+            lock_guard guard(cacheMutex);
+            cachedMeasurements[host] = bandwidthDelayProduct;
+
+            return bandwidthDelayProduct;
+        }
+
+        // merging two ranges pays off as long as fetching the gap between them takes less time than the additional
+        // round trip a separate request would need, i.e., the threshold should match the bandwidth-delay product
+        // only called for actual updates, update checks don't fetch any ranges, and thus don't need the measurements
+        unsigned long chooseRangesOptimizationThreshold(const std::string& zsyncUrl) {
+            const auto clamp = [this](unsigned long threshold) {
+                return std::clamp(threshold, minimumRangesOptimizationThreshold, maximumRangesOptimizationThreshold);
+            };
+
+            if (minimumRangesOptimizationThreshold >= maximumRangesOptimizationThreshold)
+                return clamp(defaultRangesOptimizationThreshold);
+
+            // for local files, additional requests are virtually free
+            if (!stringStartsWith(zsyncUrl, "http://") && !stringStartsWith(zsyncUrl, "https://"))
+                return minimumRangesOptimizationThreshold;
+
+            // the measurements cost a few additional requests, therefore they must be enabled explicitly
+            if (!measureConnection)
+                return clamp(defaultRangesOptimizationThreshold);
+
+            const auto bandwidthDelayProduct = measureBandwidthDelayProduct(zsyncUrl);
+
+            if (!bandwidthDelayProduct.has_value())
+                return clamp(defaultRangesOptimizationThreshold);
+
+            const auto threshold = clamp(static_cast<unsigned long>(bandwidthDelayProduct.value()));
+
+            std::ostringstream oss;
+            oss << "Merging ranges separated by less than " << threshold / 1024 << " kiB";
+            issueStatusMessage(oss.str());
+
+            return threshold;
+        }
+
+        std::shared_ptr<zsync2::ZSyncClient> makeZSyncClient(const std::string& zsyncUrl) {
+            // doesn't matter which type it is exactly, they all work like the same
+            auto client = std::make_shared<zsync2::ZSyncClient>(zsyncUrl, appImage.path(), overwrite);
+
+            // enable ranges optimizations
+            // the threshold is chosen before clients for updates are created, see chooseRangesOptimizationThreshold()
+            // clients used for update checks only never fetch any ranges
+            if (rangesOptimizationThreshold != 0)
+                client->setRangesOptimizationThreshold(rangesOptimizationThreshold);
+
+            // make sure the new AppImage goes into the same directory as the old one
+            // unfortunately, to be able to use dirname(), one has to copy the C string first
+            auto path = makeBuffer(appImage.path());
+            std::string dirPath = dirname(path.data());
+
+            client->setCwd(dirPath);
+
+            return client;
+        }
+
+        // returns the partial output zsync has left behind after a failed update
+        // only the path zsync reports for this very run is considered: other updates (e.g., in batch mode) might be
+        // writing partial output to the same directory at the same time, so guessing from the directory contents could
+        // take over their files
+        // if zsync can't tell the path of the new file, the partial output is not kept
+        std::string findPartialOutput() const {
+            std::string pathToNewFile;
+
+            if (zSyncClient == nullptr || !zSyncClient->pathToNewFile(pathToNewFile))
+                return "";
+
+            const auto partialOutput = abspath(pathToNewFile) + ".part";
+
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file(std::filesystem::symlink_status(partialOutput, ec)))
+                return "";
+
+            return partialOutput;
+        }
+
+        // returns the files to be used as seeds in addition to the AppImage itself
+        std::vector<std::string> collectSeedFiles() const {
+            const auto appImagePath = abspath(appImage.path());
+
+            std::vector<std::string> seeds;
+
+            const auto addSeed = [&appImagePath, &seeds](const std::string& path) {
+                const auto absolutePath = abspath(path);
+
+                if (absolutePath == appImagePath || !isFile(absolutePath))
+                    return;
+
+                if (std::find(seeds.begin(), seeds.end(), absolutePath) == seeds.end())
+                    seeds.emplace_back(absolutePath);
+            };
+
+            for (const auto& seedFile : seedFiles) {
+                addSeed(seedFile);
+            }
+
+            if (useSiblingSeedFiles) {
+                auto path = makeBuffer(appImagePath);
+                const std::string dirPath = dirname(path.data());
+
+                std::vector<std::string> candidates;
+
+                try {
+                    candidates = BatchUpdater::findAppImages(dirPath);
+                } catch (const std::invalid_argument&) {
+                    // not being able to use seed files is not an error
+                }
+
+                for (const auto& sibling : selectSiblingSeedFiles(appImagePath, candidates)) {
+                    addSeed(sibling);
+                }
+            }
+
+            return seeds;
+        }
+
+        // builds the ZSync URL from the update information, or returns the one built previously
+        // throws UpdateInformationError in case of unsupported update information
+        ResolvedZsyncUrl resolveZsyncUrl() {
+            lock_guard guard(resolveMutex);
+
+            if (resolvedZsyncUrl.has_value()) {
+                return *resolvedZsyncUrl;
+            }
+
+            const auto updateInformationPtr = makeUpdateInformation(rawUpdateInformation);
+            ResolvedZsyncUrl resolved;
+            resolved.url = updateInformationPtr->buildUrl(makeIssueStatusMessageCallback());
+            resolved.statusMessage = updateInformationPtr->statusMessage();
+            resolved.seedFiles = updateInformationPtr->seedFiles(resolved.url);
+
+            // failures are not memoized, as they might be caused by temporary issues, e.g., the network
+            if (!resolved.url.empty()) {
+                resolvedZsyncUrl = resolved;
+            }
+
+            return resolved;
+        }
+
+        ResolvedZsyncUrl validateAppImage() {
             // first check whether there's update information at all
             // note that we skip this check when custom update information is set intentionally
             if (this->rawUpdateInformation.empty()) {
@@ -90,24 +614,92 @@ namespace appimage::update {
                 }
             }
 
-            const auto updateInformationPtr = makeUpdateInformation(rawUpdateInformation);
-            const auto zsyncUrl = updateInformationPtr->buildUrl(makeIssueStatusMessageCallback());
+            const auto resolved = resolveZsyncUrl();
 
             // now check whether a ZSync URL could be composed by readAppImage
             // this is the only supported update type at the moment
-            if (zsyncUrl.empty()) {
+            if (resolved.url.empty()) {
                 std::ostringstream oss;
                 oss << "ZSync URL not available. See previous messages for details.";
                 throw AppImageError(oss.str());
             }
+
+            return resolved;
+        }
+
+        // removes the files created by an update that has been stopped, and restores the original AppImage
+        // the new file itself is only removed if zsync has completed it: in overwrite mode, the original AppImage
+        // remains in place until then, and the new file's path refers to it
+        void removeNewFile(bool newFileCompleted) {
+            std::string newFilePath;
+
+            if (zSyncClient == nullptr || !zSyncClient->pathToNewFile(newFilePath))
+                return;
+
+            // make sure to compare absolute, resolved paths
+            newFilePath = abspath(newFilePath);
+
+            // partial output zsync might have left behind
+            std::remove((newFilePath + ".part").c_str());
+
+            if (!newFileCompleted)
+                return;
+
+            const auto& oldFilePath = abspath(appImage.path());
+
+            std::remove(newFilePath.c_str());
+
+            if (oldFilePath == newFilePath) {
+                std::rename((newFilePath + ".zs-old").c_str(), newFilePath.c_str());
+            }
+        }
+
+        // must be called with the mutex locked
+        // returns true if the update has been stopped, in which case the update reached its final state
+        bool checkStopRequested() {
+            if (!stopRequested)
+                return false;
+
+            issueStatusMessage("Update cancelled");
+            setState(ERROR);
+
+            return true;
         }
 
         // thread runner
         void runUpdate() {
+            runUpdatePhases();
+
+            // delivers the remaining notifications, including the final state
+            stopNotifier();
+
+            bool deleteSelf;
+
+            {
+                lock_guard guard(mutex);
+
+                // in case the Updater has been destroyed while the update was running, ownership has been passed
+                // to this thread
+                deleteSelf = orphaned;
+            }
+
+            if (deleteSelf) {
+                delete this;
+            }
+        }
+
+        void runUpdatePhases() {
+            // the validation of the original AppImage does not depend on the update, so we can start right away
+            startOldAppImageValidation();
+
             // initialization
-            try {
+            {
                 lock_guard guard(mutex);
 
+                // the update might have been stopped before the thread got the chance to run
+                if (checkStopRequested())
+                    return;
+
                 // make sure it runs only once at a time
                 // should never occur, but you never know
                 if (state != INITIALIZED)
@@ -119,68 +711,143 @@ namespace appimage::update {
                     zSyncClient.reset();
                 }
 
-                validateAppImage();
-                const auto updateInformationPtr = makeUpdateInformation(rawUpdateInformation);
-
-                if (updateInformationPtr->type() == ZSYNC_GITHUB_RELEASES) {
-                    issueStatusMessage("Updating from GitHub Releases via ZSync");
-                } else if (updateInformationPtr->type() == ZSYNC_GENERIC) {
-                    issueStatusMessage("Updating from generic server via ZSync");
-                } else if (updateInformationPtr->type() == ZSYNC_PLING_V1) {
-                    issueStatusMessage("Updating from Pling v1 server via ZSync");
-                } else {
-                    throw AppImageError("Unknown update information type");
-                }
+                // the mutex must not be held while the update information is resolved, as that requires network
+                // access, and stop() must be able to interrupt the update in the meantime
+                setState(RUNNING);
+            }
+
+            std::shared_ptr<zsync2::ZSyncClient> client;
 
-                const auto zsyncUrl = updateInformationPtr->buildUrl(makeIssueStatusMessageCallback());
+            try {
+                const auto resolved = validateAppImage();
 
-                // doesn't matter which type it is exactly, they all work like the same
-                zSyncClient = std::make_shared<zsync2::ZSyncClient>(zsyncUrl, appImage.path(), overwrite);
+                issueStatusMessage(resolved.statusMessage);
 
-                // enable ranges optimizations
-                zSyncClient->setRangesOptimizationThreshold(64 * 4096);
+                rangesOptimizationThreshold = chooseRangesOptimizationThreshold(resolved.url);
+                client = makeZSyncClient(resolved.url);
 
-                // make sure the new AppImage goes into the same directory as the old one
-                // unfortunately, to be able to use dirname(), one has to copy the C string first
-                auto path = makeBuffer(appImage.path());
-                std::string dirPath = dirname(path.data());
+                const auto seeds = collectSeedFiles();
 
-                zSyncClient->setCwd(dirPath);
+                for (const auto& seed : seeds) {
+                    client->addSeedFile(seed);
+                }
 
-                state = RUNNING;
+                // some types of update information provide seeds of their own, e.g., local-zsync provides the new
+                // AppImage stored right next to the .zsync file, so nothing has to be fetched via URLs at all
+                for (const auto& seed : resolved.seedFiles) {
+                    client->addSeedFile(seed);
+                }
+
+                // the blocks an interrupted update has downloaded already can be reused like those of any other seed
+                // the journal has moved the partial output away from <new file>.part, so zsync can't pick it up on its
+                // own, and it is read exactly once
+                resumedZsyncUrl = resolved.url;
+                if (const auto partialFile = ResumeJournal().partialFile(abspath(appImage.path()), resolved.url); !partialFile.empty()) {
+                    client->addSeedFile(partialFile);
+                    issueStatusMessage("Resuming interrupted update");
+                }
+
+                if (!seeds.empty()) {
+                    std::ostringstream oss;
+                    oss << "Using " << seeds.size() << " additional seed file(s)";
+                    issueStatusMessage(oss.str());
+                }
             } catch (const AppImageError& e) {
+                lock_guard guard(mutex);
                 issueStatusMessage("Error reading AppImage: " + std::string(e.what()));
-                state = ERROR;
+                setState(ERROR);
                 return;
             } catch (const UpdateInformationError& e) {
+                lock_guard guard(mutex);
                 issueStatusMessage("Failed to parse update information: " + std::string(e.what()));
-                state = ERROR;
+                setState(ERROR);
                 return;
             }
 
+            {
+                lock_guard guard(mutex);
+
+                // last chance to stop the update before any data is written
+                if (checkStopRequested())
+                    return;
+
+                zSyncClient = client;
+            }
+
             // keep state -- by default, an error (false) is assumed
             bool result = false;
 
             // run phase
             {
-                // check whether it's a zsync operation
-                if (zSyncClient != nullptr) {
-                    result = zSyncClient->run();
-                }
+                // zsync2 does not provide a way to abort a running transfer, therefore a stop request can only be
+                // handled once it returns
+                result = zSyncClient->run();
             }
 
             // end phase
             {
                 lock_guard guard(mutex);
 
-                if (result) {
-                    state = SUCCESS;
+                if (stopRequested) {
+                    // the update must not leave a half-finished state behind
+                    removeNewFile(result);
+                    checkStopRequested();
+                } else if (result) {
+                    // the preserved partial output of a previous attempt is not needed any more
+                    ResumeJournal().remove(abspath(appImage.path()));
+
+                    setState(SUCCESS);
                 } else {
-                    state = ERROR;
+                    // unlike explicitly stopped ones, failed updates are likely to be retried, e.g., once the
+                    // connection is back, so whatever has been downloaded so far is kept for the next attempt
+                    // in case the journal can't take it over, it is left in place, like zsync always did
+                    const auto partialOutput = findPartialOutput();
+
+                    if (!partialOutput.empty() &&
+                        ResumeJournal().record(abspath(appImage.path()), resumedZsyncUrl, partialOutput)) {
+                        issueStatusMessage("Kept partial download, the next update will resume from it");
+                    }
+
+                    setState(ERROR);
                 }
             }
         }
 
+        // fetches only the header of the .zsync file and returns the SHA-1 digest of the remote file listed therein
+        // the header is tiny compared to the block checksums which follow it, so this is much cheaper than having
+        // zsync2 fetch and parse the entire file
+        static std::optional<std::string> fetchRemoteSha1Hash(const std::string& zsyncUrl) {
+            if (!stringStartsWith(zsyncUrl, "http://") && !stringStartsWith(zsyncUrl, "https://"))
+                return std::nullopt;
+
+            // servers not supporting range requests send the entire file, which is fine, too
+            auto response = httpGet(zsyncUrl, cpr::Header{{"Range", "bytes=0-4095"}});
+
+            if (response.status_code != 200 && response.status_code != 206)
+                return std::nullopt;
+
+            std::istringstream iss(response.text);
+
+            // the header ends with the first empty line
+            for (std::string line; std::getline(iss, line) && !line.empty() && line != "\r";) {
+                static const std::string prefix = "SHA-1: ";
+
+                if (!stringStartsWith(line, prefix))
+                    continue;
+
+                auto hash = line.substr(prefix.size());
+                trim(hash);
+                trim(hash, '\r');
+
+                if (hash.size() != 40)
+                    return std::nullopt;
+
+                return toLower(hash);
+            }
+
+            return std::nullopt;
+        }
+
         bool checkForChanges(bool& updateAvailable, const unsigned int method = 0) {
             lock_guard guard(mutex);
 
@@ -196,9 +863,28 @@ namespace appimage::update {
             }
 
             try {
-                auto updateInformationPtr = makeUpdateInformation(rawUpdateInformation);
-                const auto zsyncUrl = updateInformationPtr->buildUrl(makeIssueStatusMessageCallback());
-                zSyncClient.reset(new zsync2::ZSyncClient(zsyncUrl, appImage.path()));
+                // the URL has been resolved by validateAppImage() already
+                const auto zsyncUrl = resolveZsyncUrl().url;
+
+                // method 0 compares the SHA-1 digest of the local file with the one in the .zsync header
+                // the local digest is cached persistently, so repeated checks neither have to read the entire
+                // AppImage nor fetch the entire .zsync file
+                if (method == 0) {
+                    if (const auto remoteHash = fetchRemoteSha1Hash(zsyncUrl); remoteHash.has_value()) {
+                        try {
+                            const auto localHash = toLower(
+                                useHashCache ? HashCache().calculateSha1Hash(appImage) : appImage.calculateSha1Hash()
+                            );
+
+                            updateAvailable = localHash != remoteHash.value();
+                            return true;
+                        } catch (const AppImageError&) {
+                            // zsync2 will give it another try below, and report the error properly if need be
+                        }
+                    }
+                }
+
+                zSyncClient = makeZSyncClient(zsyncUrl);
                 return zSyncClient->checkForChanges(updateAvailable, method);
             } catch (const UpdateInformationError& e) {
                 zSyncClient.reset();
@@ -224,7 +910,46 @@ namespace appimage::update {
         }
     }
 
-    Updater::~Updater() = default;
+    Updater::~Updater() {
+        if (d->thread == nullptr)
+            return;
+
+        // the callbacks most likely refer to the caller's objects, so they must not be called any more
+        // if a callback is being called right now, this waits for it to return
+        {
+            lock_guard guard(d->callbackMutex);
+            d->callbacksEnabled = false;
+        }
+
+        std::thread* thread = d->thread;
+        bool orphan;
+
+        {
+            lock_guard guard(d->mutex);
+
+            // waiting for a running update to finish would block the caller for an unpredictable amount of time
+            // therefore, the update is stopped, and the thread cleans up behind itself once it is done
+            orphan = d->state == INITIALIZED || d->state == RUNNING || d->state == STOPPING;
+
+            if (orphan) {
+                d->stopRequested = true;
+                d->orphaned = true;
+                d->thread = nullptr;
+            }
+        }
+
+        if (orphan) {
+            thread->detach();
+            delete thread;
+
+            // ownership has been passed to the update thread
+            (void) d.release();
+            return;
+        }
+
+        thread->join();
+        delete thread;
+    }
 
     void Updater::runUpdate() {
         // alias for private function
@@ -244,8 +969,12 @@ namespace appimage::update {
         if(d->thread)
             return false;
 
+        // the notifier must be running before the update thread can issue any notifications
+        if (d->hasCallbacks())
+            d->startNotifier();
+
         // create thread
-        d->thread = new std::thread(&Updater::runUpdate, this);
+        d->thread = new std::thread(&Private::runUpdate, d.get());
 
         return true;
     }
@@ -265,46 +994,35 @@ namespace appimage::update {
     bool Updater::progress(double& progress) {
         lock_guard guard(d->mutex);
 
-        if (d->state == INITIALIZED) {
-            // this protects update checks from returning progress, which would only occur when using method 0
-            progress = 0;
-            return true;
-        } else if (d->state == SUCCESS || d->state == ERROR) {
-            progress = 1;
-            return true;
-        }
-
-        if (d->zSyncClient != nullptr) {
-            progress = d->zSyncClient->progress();
-            return true;
-        }
-
-        return false;
+        return d->progress(progress);
     }
 
     bool Updater::stop() {
-        throw std::runtime_error("not implemented");
+        lock_guard guard(d->mutex);
+
+        if (d->thread == nullptr)
+            throw std::logic_error("update has not been started");
+
+        if (d->stopRequested)
+            return false;
+
+        d->stopRequested = true;
+
+        // the update thread switches to the final state as soon as it has cleaned up
+        if (d->state == INITIALIZED || d->state == RUNNING)
+            d->setState(STOPPING);
+
+        return true;
     }
 
     bool Updater::nextStatusMessage(std::string& message) {
-        // first, check own message queue
-        if (!d->statusMessages.empty()) {
-            message = d->statusMessages.front();
-            d->statusMessages.pop_front();
-            return true;
-        }
+        lock_guard guard(d->mutex);
 
-        // next, check zsync client for a message
-        if (d->zSyncClient != nullptr) {
-            std::string zsyncMessage;
-            if (!d->zSyncClient->nextStatusMessage(zsyncMessage))
-                return false;
-            // show that the message is coming from zsync2
-            message = "zsync2: " + zsyncMessage;
-            return true;
-        }
+        // while the update is running, the messages are delivered to the callback
+        if (d->statusMessageCallback && d->notifierActive)
+            return false;
 
-        return false;
+        return d->nextStatusMessage(message);
     }
 
     Updater::State Updater::state() {
@@ -334,18 +1052,7 @@ namespace appimage::update {
 
             auto updateInformation = makeUpdateInformation(rawUpdateInformation);
 
-            oss << "Update information type: ";
-
-            if (updateInformation->type() == ZSYNC_GENERIC)
-                oss << "Generic ZSync URL";
-            else if (updateInformation->type() == ZSYNC_GITHUB_RELEASES)
-                oss << "ZSync via GitHub Releases";
-            else if (updateInformation->type() == ZSYNC_PLING_V1)
-                oss << "ZSync via OCS";
-            else
-                throw std::runtime_error("unsupported update information type");
-
-            oss << std::endl;
+            oss << "Update information type: " << updateInformation->description() << std::endl;
 
             try {
                 auto url = updateInformation->buildUrl(d->makeIssueStatusMessageCallback());
@@ -393,23 +1100,44 @@ namespace appimage::update {
 
         UpdatableAppImage newAppImage(pathToNewAppImage);
 
-        auto pathToOldAppImage = abspath(d->appImage.path());
-        if (pathToOldAppImage == pathToNewAppImage) {
-            pathToOldAppImage = pathToNewAppImage + ".zs-old";
+        // normally, the original AppImage has been validated in the background during the update already
+        // if that has not happened, we validate it now
+        if (!d->oldAppImageValidation.valid()) {
+            auto pathToOldAppImage = abspath(d->appImage.path());
+            if (pathToOldAppImage == pathToNewAppImage) {
+                pathToOldAppImage = pathToNewAppImage + ".zs-old";
+            }
+
+            d->oldAppImageValidation = std::async(
+                std::launch::deferred, &Private::validateOldAppImage, UpdatableAppImage(pathToOldAppImage), d->useHashCache
+            ).share();
         }
 
-        UpdatableAppImage oldAppImage(pathToOldAppImage);
+        // rethrows any exception that occurred during the validation of the old AppImage
+        const auto& oldAppImageValidation = d->oldAppImageValidation.get();
 
-        if (oldAppImage.readSignature().empty() && newAppImage.readSignature().empty()) {
+        if (!oldAppImageValidation.isSigned && newAppImage.readSignature().empty()) {
             return VALIDATION_NOT_SIGNED;
-        } else if (!oldAppImage.readSignature().empty() && newAppImage.readSignature().empty()) {
+        } else if (oldAppImageValidation.isSigned && newAppImage.readSignature().empty()) {
             return VALIDATION_NO_LONGER_SIGNED;
         }
 
-        // we can re-use the same validation context to validate the signatures of both AppImages
-        SignatureValidator validator;
+        SignatureValidator validator(d->useHashCache);
+
+        // an AppImage which has not been signed before can only be validated on its own
+        // as there is no previous key its key could be compared to, a valid signature results in a warning at best
+        if (!oldAppImageValidation.isSigned) {
+            const auto newAppImageValidationResult = validator.validate(newAppImage);
+            d->issueStatusMessage("New AppImage signature validation report:\n" + newAppImageValidationResult.message());
 
-        const auto oldAppImageValidationResult = validator.validate(oldAppImage);
+            if (newAppImageValidationResult.type() == SignatureValidationResult::ResultType::ERROR) {
+                return VALIDATION_BAD_SIGNATURE;
+            }
+
+            return VALIDATION_WARNING;
+        }
+
+        const auto& oldAppImageValidationResult = *oldAppImageValidation.result;
         d->issueStatusMessage("Old AppImage signature validation report:\n" + oldAppImageValidationResult.message());
 
         if (oldAppImageValidationResult.type() == SignatureValidationResult::ResultType::ERROR) {
@@ -417,7 +1145,7 @@ namespace appimage::update {
         }
 
         const auto newAppImageValidationResult = validator.validate(newAppImage);
-        d->issueStatusMessage("New AppImage signature validation report:\n" + oldAppImageValidationResult.message());
+        d->issueStatusMessage("New AppImage signature validation report:\n" + newAppImageValidationResult.message());
 
         if (newAppImageValidationResult.type() == SignatureValidationResult::ResultType::ERROR) {
             return VALIDATION_BAD_SIGNATURE;
@@ -511,6 +1239,56 @@ namespace appimage::update {
     }
 
     void Updater::setUpdateInformation(std::string newUpdateInformation) {
-        d->rawUpdateInformation = std::move(newUpdateInformation);
+        {
+            lock_guard guard(d->resolveMutex);
+            d->rawUpdateInformation = std::move(newUpdateInformation);
+
+            // the URL must be resolved again from the new update information
+            d->resolvedZsyncUrl.reset();
+        }
+    }
+
+    void Updater::setProgressCallback(ProgressCallback callback) {
+        d->progressCallback = std::move(callback);
+    }
+
+    void Updater::setStateCallback(StateCallback callback) {
+        d->stateCallback = std::move(callback);
+    }
+
+    void Updater::setStatusMessageCallback(StatusMessageCallback callback) {
+        d->statusMessageCallback = std::move(callback);
+    }
+
+    void Updater::setCallbackInterval(unsigned int milliseconds) {
+        d->callbackInterval = std::chrono::milliseconds(milliseconds);
+    }
+
+    void Updater::addSeedFile(const std::string& path) {
+        d->seedFiles.emplace_back(path);
+    }
+
+    void Updater::setUseSiblingSeedFiles(bool useSiblingSeedFiles) {
+        d->useSiblingSeedFiles = useSiblingSeedFiles;
+    }
+
+    void Updater::setUseHashCache(bool useHashCache) {
+        d->useHashCache = useHashCache;
+    }
+
+    void Updater::setRangesOptimizationThresholdBounds(unsigned long minimum, unsigned long maximum) {
+        if (minimum > maximum)
+            throw std::invalid_argument("minimum ranges optimization threshold must not exceed maximum");
+
+        d->minimumRangesOptimizationThreshold = minimum;
+        d->maximumRangesOptimizationThreshold = maximum;
+    }
+
+    void Updater::setMeasureConnection(bool measureConnection) {
+        d->measureConnection = measureConnection;
+    }
+
+    unsigned long Updater::rangesOptimizationThreshold() const {
+        return d->rangesOptimizationThreshold;
     }
 }
@@ -0,0 +1,161 @@
+// system headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+
+// local headers
+#include "appimagemetadata.h"
+#include "util/updatableappimage.h"
+
+namespace appimage::update {
+    namespace {
+        // everything the type detection needs is located within the first few kiB of the file, so we read them at once
+        constexpr size_t headerSize = 64 * 1024;
+
+        constexpr off_t magicBytesPos = 8;
+        constexpr size_t magicBytesLength = 3;
+
+        // note: this is not the real ELF magic value, but it is what the type detection has always compared with
+        const std::string elfMagicValue = "\7ELF";
+
+        constexpr off_t isoMagicPos = 32769;
+        const std::string isoMagicValue = "CD001";
+
+        // position and maximum length of the update information in type 1 AppImages
+        constexpr off_t type1UpdateInformationPos = 0x8373;
+        constexpr size_t type1UpdateInformationLength = 512;
+
+        // reads until count bytes have been read or the end of the file has been reached, returns the bytes read
+        ssize_t preadFully(int fd, char* buffer, size_t count, off_t offset) {
+            size_t bytesRead = 0;
+
+            while (bytesRead < count) {
+                const auto rv = pread(fd, buffer + bytesRead, count - bytesRead, offset + static_cast<off_t>(bytesRead));
+
+                if (rv < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (rv < 0) {
+                    return rv;
+                }
+
+                if (rv == 0) {
+                    break;
+                }
+
+                bytesRead += rv;
+            }
+
+            return static_cast<ssize_t>(bytesRead);
+        }
+
+        std::string extract(const std::vector<char>& header, off_t pos, size_t length) {
+            if (static_cast<size_t>(pos) >= header.size()) {
+                return "";
+            }
+
+            return {header.data() + pos, std::min(length, header.size() - pos)};
+        }
+    }
+
+    AppImageMetadata::AppImageMetadata(std::string path) : _path(std::move(path)) {
+        const auto throwReadError = [this]() {
+            throw AppImageError("Error while opening/accessing/reading from AppImage: " + _path);
+        };
+
+        _fd = FileDescriptor(open(_path.c_str(), O_RDONLY | O_CLOEXEC));
+
+        if (_fd.get() < 0) {
+            throwReadError();
+        }
+
+        struct stat st{};
+
+        if (fstat(_fd.get(), &st) != 0) {
+            throwReadError();
+        }
+
+        _fileSize = st.st_size;
+
+        std::vector<char> header(std::min(headerSize, static_cast<size_t>(_fileSize)));
+
+        const auto headerBytesRead = preadFully(_fd.get(), header.data(), header.size(), 0);
+
+        if (headerBytesRead < 0) {
+            throwReadError();
+        }
+
+        header.resize(headerBytesRead);
+
+        _magicBytes = extract(header, magicBytesPos, magicBytesLength);
+        _hasElfMagicValue = extract(header, 0, elfMagicValue.size()) == elfMagicValue;
+        _hasIsoMagicValue = extract(header, isoMagicPos, isoMagicValue.size()) == isoMagicValue;
+
+        {
+            // the update information is a null-terminated string within a fixed size field
+            const auto rawType1UpdateInformation = extract(header, type1UpdateInformationPos, type1UpdateInformationLength);
+            _type1UpdateInformation = rawType1UpdateInformation.c_str();
+        }
+
+        _elfSectionIndex = std::make_unique<ElfSectionIndex>(_fd.get(), _fileSize);
+    }
+
+    const std::string& AppImageMetadata::path() const {
+        return _path;
+    }
+
+    int AppImageMetadata::fd() const {
+        return _fd.get();
+    }
+
+    off_t AppImageMetadata::fileSize() const {
+        return _fileSize;
+    }
+
+    const std::string& AppImageMetadata::magicBytes() const {
+        return _magicBytes;
+    }
+
+    bool AppImageMetadata::hasElfMagicValue() const {
+        return _hasElfMagicValue;
+    }
+
+    bool AppImageMetadata::hasIsoMagicValue() const {
+        return _hasIsoMagicValue;
+    }
+
+    const std::string& AppImageMetadata::type1UpdateInformation() const {
+        return _type1UpdateInformation;
+    }
+
+    AppImageMetadata::ElfSection AppImageMetadata::elfSection(std::string_view name) const {
+        ElfSection section;
+
+        ElfSectionIndex::Section indexedSection;
+
+        if (!_elfSectionIndex->find(name, indexedSection)) {
+            return section;
+        }
+
+        section.found = true;
+        section.offset = indexedSection.offset;
+        section.length = indexedSection.length;
+
+        // sections occupying no space in the file (SHT_NOBITS) have no contents
+        if (section.offset != 0 && section.length != 0 && !indexedSection.noBits) {
+            // sections are padded with null bytes, their contents are used as null-terminated strings
+            const auto data = _elfSectionIndex->data(name);
+            section.contents = data.substr(0, strnlen(data.data(), data.size()));
+        }
+
+        return section;
+    }
+
+    const ElfSectionIndex& AppImageMetadata::elfSectionIndex() const {
+        return *_elfSectionIndex;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// system headers
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+// local headers
+#include "util/elfsectionindex.h"
+#include "util/filedescriptor.h"
+
+namespace appimage::update {
+    /**
+     * Metadata of an AppImage, parsed in a single pass.
+     *
+     * The file is opened exactly once, and stays open for the lifetime of the object. The AppImage type is detected
+     * from the beginning of the file, and the ELF section table is indexed once. Section contents are served from
+     * the index without copying them.
+     * All data is cached, therefore the object represents a snapshot of the file at the time it was created.
+     *
+     * Files which are not AppImages can be parsed, too. The type detection results are available through the
+     * respective getters, it is up to the caller to decide how to handle them.
+     */
+    class AppImageMetadata {
+    public:
+        struct ElfSection {
+            bool found = false;
+            unsigned long offset = 0;
+            unsigned long length = 0;
+            // null-terminated contents of the section, valid as long as the metadata object exists
+            std::string_view contents;
+        };
+
+    private:
+        std::string _path;
+        FileDescriptor _fd;
+        off_t _fileSize = 0;
+
+        // raw magic bytes at offset 8, contain the type for types 1 and 2
+        std::string _magicBytes;
+        bool _hasElfMagicValue = false;
+        bool _hasIsoMagicValue = false;
+
+        // type 1 AppImages store their update information at a fixed position
+        std::string _type1UpdateInformation;
+
+        std::unique_ptr<ElfSectionIndex> _elfSectionIndex;
+
+    public:
+        // throws AppImageError if the file cannot be opened or read
+        explicit AppImageMetadata(std::string path);
+
+    public:
+        [[nodiscard]] const std::string& path() const;
+
+        // file descriptor the metadata have been read from, can be used to read further data from the same file
+        [[nodiscard]] int fd() const;
+
+        [[nodiscard]] off_t fileSize() const;
+
+        // may contain less than three bytes for very small files
+        [[nodiscard]] const std::string& magicBytes() const;
+
+        [[nodiscard]] bool hasElfMagicValue() const;
+
+        [[nodiscard]] bool hasIsoMagicValue() const;
+
+        [[nodiscard]] const std::string& type1UpdateInformation() const;
+
+        // for sections not found in the file (or files which are not ELF files), the found flag is false
+        [[nodiscard]] ElfSection elfSection(std::string_view name) const;
+
+        [[nodiscard]] const ElfSectionIndex& elfSectionIndex() const;
+    };
+}
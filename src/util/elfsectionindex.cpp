@@ -0,0 +1,278 @@
+// system headers
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <elf.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+// local headers
+#include "elfsectionindex.h"
+
+namespace appimage::update {
+    namespace {
+        // reads count bytes, returns false if that is not possible (e.g., due to a truncated file)
+        bool preadExactly(int fd, void* buffer, size_t count, off_t offset) {
+            size_t bytesRead = 0;
+
+            while (bytesRead < count) {
+                const auto rv = pread(fd, static_cast<char*>(buffer) + bytesRead, count - bytesRead, offset + static_cast<off_t>(bytesRead));
+
+                if (rv < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (rv <= 0) {
+                    return false;
+                }
+
+                bytesRead += rv;
+            }
+
+            return true;
+        }
+
+        // reads integers of the file's byte order, regardless of the host's byte order
+        class FieldReader {
+        private:
+            bool _swap;
+
+        public:
+            explicit FieldReader(bool fileIsLittleEndian) {
+                const uint16_t probe = 1;
+                uint8_t firstByte;
+                std::memcpy(&firstByte, &probe, 1);
+                const bool hostIsLittleEndian = firstByte == 1;
+
+                _swap = hostIsLittleEndian != fileIsLittleEndian;
+            }
+
+            template<typename T>
+            T read(const char* data, size_t offset) const {
+                T value;
+                std::memcpy(&value, data + offset, sizeof(T));
+
+                if (_swap) {
+                    auto* bytes = reinterpret_cast<uint8_t*>(&value);
+                    std::reverse(bytes, bytes + sizeof(T));
+                }
+
+                return value;
+            }
+        };
+
+        // the fields of the ELF32 and ELF64 structures which are needed to build the index
+        struct SectionHeader {
+            uint32_t name = 0;
+            uint32_t type = 0;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t link = 0;
+        };
+
+        SectionHeader readSectionHeader(const FieldReader& reader, const char* data, bool is64Bit) {
+            SectionHeader header;
+
+            if (is64Bit) {
+                header.name = reader.read<uint32_t>(data, offsetof(Elf64_Shdr, sh_name));
+                header.type = reader.read<uint32_t>(data, offsetof(Elf64_Shdr, sh_type));
+                header.offset = reader.read<uint64_t>(data, offsetof(Elf64_Shdr, sh_offset));
+                header.size = reader.read<uint64_t>(data, offsetof(Elf64_Shdr, sh_size));
+                header.link = reader.read<uint32_t>(data, offsetof(Elf64_Shdr, sh_link));
+            } else {
+                header.name = reader.read<uint32_t>(data, offsetof(Elf32_Shdr, sh_name));
+                header.type = reader.read<uint32_t>(data, offsetof(Elf32_Shdr, sh_type));
+                header.offset = reader.read<uint32_t>(data, offsetof(Elf32_Shdr, sh_offset));
+                header.size = reader.read<uint32_t>(data, offsetof(Elf32_Shdr, sh_size));
+                header.link = reader.read<uint32_t>(data, offsetof(Elf32_Shdr, sh_link));
+            }
+
+            return header;
+        }
+    }
+
+    ElfSectionIndex::ElfSectionIndex(int fd, off_t fileSize) {
+        _parse(fd, fileSize);
+    }
+
+    ElfSectionIndex::~ElfSectionIndex() {
+        if (_mapping != nullptr) {
+            munmap(_mapping, _mappingSize);
+        }
+    }
+
+    void ElfSectionIndex::_parse(int fd, off_t fileSize) {
+        // the ELF64 header is the larger one, and contains the identification bytes at the same position
+        char ehdr[sizeof(Elf64_Ehdr)];
+
+        if (fileSize < static_cast<off_t>(EI_NIDENT) || !preadExactly(fd, ehdr, std::min(sizeof(ehdr), static_cast<size_t>(fileSize)), 0)) {
+            return;
+        }
+
+        if (std::memcmp(ehdr, ELFMAG, SELFMAG) != 0) {
+            return;
+        }
+
+        const auto elfClass = ehdr[EI_CLASS];
+        const auto elfData = ehdr[EI_DATA];
+
+        if ((elfClass != ELFCLASS32 && elfClass != ELFCLASS64) || (elfData != ELFDATA2LSB && elfData != ELFDATA2MSB)) {
+            return;
+        }
+
+        const bool is64Bit = elfClass == ELFCLASS64;
+        const FieldReader reader(elfData == ELFDATA2LSB);
+
+        if (fileSize < static_cast<off_t>(is64Bit ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr))) {
+            return;
+        }
+
+        uint64_t shoff;
+        uint16_t shentsize, shnum, shstrndx;
+
+        if (is64Bit) {
+            shoff = reader.read<uint64_t>(ehdr, offsetof(Elf64_Ehdr, e_shoff));
+            shentsize = reader.read<uint16_t>(ehdr, offsetof(Elf64_Ehdr, e_shentsize));
+            shnum = reader.read<uint16_t>(ehdr, offsetof(Elf64_Ehdr, e_shnum));
+            shstrndx = reader.read<uint16_t>(ehdr, offsetof(Elf64_Ehdr, e_shstrndx));
+        } else {
+            shoff = reader.read<uint32_t>(ehdr, offsetof(Elf32_Ehdr, e_shoff));
+            shentsize = reader.read<uint16_t>(ehdr, offsetof(Elf32_Ehdr, e_shentsize));
+            shnum = reader.read<uint16_t>(ehdr, offsetof(Elf32_Ehdr, e_shnum));
+            shstrndx = reader.read<uint16_t>(ehdr, offsetof(Elf32_Ehdr, e_shstrndx));
+        }
+
+        const size_t minimumShentsize = is64Bit ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+
+        if (shoff == 0 || shentsize < minimumShentsize || shoff >= static_cast<uint64_t>(fileSize)) {
+            return;
+        }
+
+        // files with many sections store the real section count and string table index in the first section header
+        uint64_t sectionCount = shnum;
+        uint64_t stringTableIndex = shstrndx;
+
+        if (shnum == 0 || shstrndx == SHN_XINDEX) {
+            std::vector<char> firstHeader(shentsize);
+
+            if (!preadExactly(fd, firstHeader.data(), firstHeader.size(), static_cast<off_t>(shoff))) {
+                return;
+            }
+
+            const auto header = readSectionHeader(reader, firstHeader.data(), is64Bit);
+
+            if (shnum == 0) {
+                sectionCount = header.size;
+            }
+
+            if (shstrndx == SHN_XINDEX) {
+                stringTableIndex = header.link;
+            }
+        }
+
+        // the count read from the first section header is arbitrary, so the header table must be checked to fit into
+        // the file before the count is used in any calculation or allocation
+        if (sectionCount == 0 || sectionCount > (static_cast<uint64_t>(fileSize) - shoff) / shentsize || stringTableIndex >= sectionCount) {
+            return;
+        }
+
+        const auto headerTableEnd = shoff + sectionCount * shentsize;
+
+        // read the section header table to find out how much of the file we have to map
+        std::vector<char> headerTable(sectionCount * shentsize);
+
+        if (!preadExactly(fd, headerTable.data(), headerTable.size(), static_cast<off_t>(shoff))) {
+            return;
+        }
+
+        std::vector<SectionHeader> headers;
+        headers.reserve(sectionCount);
+
+        uint64_t regionEnd = headerTableEnd;
+
+        for (uint64_t i = 0; i < sectionCount; ++i) {
+            const auto header = readSectionHeader(reader, headerTable.data() + i * shentsize, is64Bit);
+
+            if (header.type != SHT_NOBITS) {
+                // sections must not exceed the file
+                if (header.offset > static_cast<uint64_t>(fileSize) || header.size > static_cast<uint64_t>(fileSize) - header.offset) {
+                    return;
+                }
+
+                regionEnd = std::max(regionEnd, header.offset + header.size);
+            }
+
+            headers.emplace_back(header);
+        }
+
+        const auto& stringTableHeader = headers[stringTableIndex];
+
+        if (stringTableHeader.type == SHT_NOBITS) {
+            return;
+        }
+
+        // on 32-bit systems, the region might exceed the address space
+        if (regionEnd > static_cast<uint64_t>(SIZE_MAX)) {
+            return;
+        }
+
+        auto* mapping = mmap(nullptr, static_cast<size_t>(regionEnd), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED) {
+            return;
+        }
+
+        _mapping = mapping;
+        _mappingSize = static_cast<size_t>(regionEnd);
+
+        const auto* data = static_cast<const char*>(_mapping);
+        const auto* stringTable = data + stringTableHeader.offset;
+        const auto stringTableSize = stringTableHeader.size;
+
+        for (const auto& header : headers) {
+            if (header.name >= stringTableSize) {
+                continue;
+            }
+
+            // names are null-terminated, but we must not rely on that for the last one
+            const auto* name = stringTable + header.name;
+            const auto nameLength = strnlen(name, stringTableSize - header.name);
+
+            Section section;
+            section.offset = header.offset;
+            section.length = header.size;
+            section.noBits = header.type == SHT_NOBITS;
+
+            // like other ELF tools, we use the first section of a given name
+            _sections.emplace(std::string_view(name, nameLength), section);
+        }
+    }
+
+    bool ElfSectionIndex::empty() const {
+        return _sections.empty();
+    }
+
+    bool ElfSectionIndex::find(std::string_view name, Section& section) const {
+        const auto it = _sections.find(name);
+
+        if (it == _sections.end()) {
+            return false;
+        }
+
+        section = it->second;
+        return true;
+    }
+
+    std::string_view ElfSectionIndex::data(std::string_view name) const {
+        Section section;
+
+        if (!find(name, section) || section.noBits) {
+            return {};
+        }
+
+        return {static_cast<const char*>(_mapping) + section.offset, section.length};
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+namespace appimage::update {
+    /**
+     * Index of the sections of an ELF file (ELF32 and ELF64, both byte orders).
+     *
+     * The ELF header and section header table are parsed once. Only the region of the file which contains the ELF
+     * headers and sections is mapped into memory, for AppImages this is the runtime only, not the payload appended
+     * to it. Section contents can then be accessed as views into the mapping, without copying them.
+     *
+     * Files which are not ELF files or whose headers are malformed result in an empty index.
+     */
+    class ElfSectionIndex {
+    public:
+        struct Section {
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            // set for sections occupying no space in the file, e.g., .bss
+            bool noBits = false;
+        };
+
+    private:
+        void* _mapping = nullptr;
+        size_t _mappingSize = 0;
+
+        // names are views into the section header string table within the mapping
+        std::map<std::string_view, Section> _sections;
+
+    private:
+        void _parse(int fd, off_t fileSize);
+
+    public:
+        // fd must be readable, and may be closed after the index has been created
+        ElfSectionIndex(int fd, off_t fileSize);
+
+        ~ElfSectionIndex();
+
+        ElfSectionIndex(const ElfSectionIndex&) = delete;
+        ElfSectionIndex& operator=(const ElfSectionIndex&) = delete;
+
+    public:
+        [[nodiscard]] bool empty() const;
+
+        // returns true and sets section if a section with the given name exists
+        bool find(std::string_view name, Section& section) const;
+
+        // returns a view on the raw contents of the given section, which remains valid as long as the index exists
+        // returns an empty view if the section does not exist or does not occupy space in the file
+        [[nodiscard]] std::string_view data(std::string_view name) const;
+    };
+}
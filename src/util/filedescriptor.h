@@ -0,0 +1,45 @@
+#pragma once
+
+// system headers
+#include <unistd.h>
+
+namespace appimage::update {
+    // owns a POSIX file descriptor and closes it when going out of scope
+    class FileDescriptor {
+    private:
+        int _fd;
+
+    public:
+        explicit FileDescriptor(int fd = -1) : _fd(fd) {}
+
+        ~FileDescriptor() {
+            if (_fd >= 0) {
+                close(_fd);
+            }
+        }
+
+        FileDescriptor(const FileDescriptor&) = delete;
+        FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+        FileDescriptor(FileDescriptor&& other) noexcept : _fd(other._fd) {
+            other._fd = -1;
+        }
+
+        FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+            if (this != &other) {
+                if (_fd >= 0) {
+                    close(_fd);
+                }
+
+                _fd = other._fd;
+                other._fd = -1;
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]] int get() const {
+            return _fd;
+        }
+    };
+}
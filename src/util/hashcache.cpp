@@ -0,0 +1,193 @@
+// system headers
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+
+// local headers
+#include "hashcache.h"
+#include "util/appimagemetadata.h"
+#include "util/util.h"
+
+namespace appimage::update {
+    using namespace util;
+
+    namespace {
+        // must be increased whenever the format of the entries or the way the digest is calculated changes
+        constexpr int cacheFormatVersion = 2;
+
+        // files modified more recently than this are not cached, as further modifications within the timestamp
+        // granularity of the filesystem could not be detected
+        constexpr long long minimumEntryAgeNs = 2'000'000'000LL;
+
+        struct FileIdentity {
+            unsigned long long device = 0;
+            unsigned long long inode = 0;
+            long long size = 0;
+            long long mtimeNs = 0;
+            long long ctimeNs = 0;
+
+            bool operator==(const FileIdentity& other) const {
+                return device == other.device && inode == other.inode && size == other.size &&
+                       mtimeNs == other.mtimeNs && ctimeNs == other.ctimeNs;
+            }
+
+            bool operator!=(const FileIdentity& other) const {
+                return !(*this == other);
+            }
+        };
+
+        bool statFile(int fd, FileIdentity& identity) {
+            struct stat st{};
+
+            if (fstat(fd, &st) != 0) {
+                return false;
+            }
+
+            identity.device = st.st_dev;
+            identity.inode = st.st_ino;
+            identity.size = st.st_size;
+            identity.mtimeNs = st.st_mtim.tv_sec * 1'000'000'000LL + st.st_mtim.tv_nsec;
+            identity.ctimeNs = st.st_ctim.tv_sec * 1'000'000'000LL + st.st_ctim.tv_nsec;
+
+            return true;
+        }
+
+        std::string entryName(const FileIdentity& identity) {
+            std::ostringstream oss;
+            oss << identity.device << "-" << identity.inode;
+            return oss.str();
+        }
+
+        // the entry header contains the complete identity, making sure a reused inode number cannot yield stale data
+        std::string entryHeader(const FileIdentity& identity) {
+            std::ostringstream oss;
+            oss << "appimageupdate-hash-cache " << cacheFormatVersion << " "
+                << identity.device << " " << identity.inode << " " << identity.size << " "
+                << identity.mtimeNs << " " << identity.ctimeNs;
+            return oss.str();
+        }
+
+        // entries hold one "<kind> <digest>" line per kind of digest calculated so far
+        using Digests = std::map<std::string, std::string>;
+
+        Digests readEntry(const std::string& entryPath, const FileIdentity& identity) {
+            Digests digests;
+
+            if (!isPrivateFile(entryPath)) {
+                return digests;
+            }
+
+            std::ifstream ifs(entryPath);
+
+            std::string header;
+            if (!std::getline(ifs, header) || header != entryHeader(identity)) {
+                return digests;
+            }
+
+            std::string line;
+            while (std::getline(ifs, line)) {
+                const auto separator = line.find(' ');
+
+                if (separator == std::string::npos) {
+                    continue;
+                }
+
+                auto digest = line.substr(separator + 1);
+                trim(digest);
+
+                if (!digest.empty()) {
+                    digests[line.substr(0, separator)] = digest;
+                }
+            }
+
+            return digests;
+        }
+    }
+
+    HashCache::HashCache(std::string directory) : _directory(std::move(directory)) {
+        // without a cache directory, the directory remains empty, which disables the cache
+        if (_directory.empty() && !cacheDirectory().empty()) {
+            _directory = cacheDirectory() + "/hashes";
+        }
+    }
+
+    std::string HashCache::lookUpOrCalculate(
+        const UpdatableAppImage& appImage,
+        const std::string& kind,
+        const std::function<std::string()>& calculate
+    ) const {
+        // we inspect the file the digest is calculated from rather than the path, which might have been replaced
+        // by a different file in the meantime
+        const auto fd = appImage.metadata().fd();
+
+        FileIdentity identity;
+
+        // in case the file can't be inspected, we can't use the cache
+        // the same goes for directories other users could have planted entries in
+        if (_directory.empty() || !statFile(fd, identity)) {
+            return calculate();
+        }
+
+        const auto entryPath = _directory + "/" + entryName(identity);
+
+        auto digests = isPrivateDirectory(_directory) ? readEntry(entryPath, identity) : Digests{};
+
+        {
+            const auto it = digests.find(kind);
+
+            if (it != digests.end()) {
+                return it->second;
+            }
+        }
+
+        auto digest = calculate();
+
+        // make sure the file has not been modified while we were hashing it, and is not too fresh
+        FileIdentity identityAfterHashing;
+        if (!statFile(fd, identityAfterHashing) || identityAfterHashing != identity) {
+            return digest;
+        }
+
+        const auto nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+
+        if (nowNs - identity.mtimeNs < minimumEntryAgeNs || nowNs - identity.ctimeNs < minimumEntryAgeNs) {
+            return digest;
+        }
+
+        if (!ensurePrivateDirectory(_directory)) {
+            return digest;
+        }
+
+        // digests of other kinds stored in the meantime by concurrent processes might get lost, which merely
+        // results in them being calculated once more
+        digests[kind] = digest;
+
+        std::ostringstream entry;
+        entry << entryHeader(identity) << std::endl;
+
+        for (const auto& [storedKind, storedDigest] : digests) {
+            entry << storedKind << " " << storedDigest << std::endl;
+        }
+
+        // concurrent readers never see incomplete entries, and failing to store the entry merely causes a cache miss
+        (void) writePrivateFile(entryPath, entry.str());
+
+        return digest;
+    }
+
+    std::string HashCache::calculateHash(const UpdatableAppImage& appImage) const {
+        return lookUpOrCalculate(appImage, "sha256-signature", [&appImage]() {
+            return appImage.calculateHash();
+        });
+    }
+
+    std::string HashCache::calculateSha1Hash(const UpdatableAppImage& appImage) const {
+        return lookUpOrCalculate(appImage, "sha1", [&appImage]() {
+            return appImage.calculateSha1Hash();
+        });
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// system headers
+#include <functional>
+#include <string>
+
+// local headers
+#include "util/updatableappimage.h"
+
+namespace appimage::update {
+    /**
+     * Persistent on-disk cache for the digests calculated by UpdatableAppImage.
+     *
+     * Entries are keyed by the file's device and inode numbers, and are only considered valid as long as size,
+     * modification time and change time of the file are unchanged. Any write to the file, chmod(), or replacing the
+     * file by a rename() therefore invalidates the entry.
+     *
+     * The cache is strictly best-effort: I/O errors never cause failures, they merely result in cache misses.
+     */
+    class HashCache {
+    private:
+        std::string _directory;
+
+        // returns the digest of the given kind from the cache, or calculates and stores it
+        [[nodiscard]] std::string lookUpOrCalculate(
+            const UpdatableAppImage& appImage,
+            const std::string& kind,
+            const std::function<std::string()>& calculate
+        ) const;
+
+    public:
+        // by default, the cache is stored within cacheDirectory()
+        explicit HashCache(std::string directory = "");
+
+    public:
+        // returns the digest for the given AppImage, either from the cache or by calculating (and storing) it
+        [[nodiscard]] std::string calculateHash(const UpdatableAppImage& appImage) const;
+
+        // same as calculateHash(), but for the SHA-1 digest of the entire file as used by zsync
+        [[nodiscard]] std::string calculateSha1Hash(const UpdatableAppImage& appImage) const;
+    };
+}
@@ -0,0 +1,201 @@
+// system headers
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// local headers
+#include "httpcache.h"
+#include "util/httpsession.h"
+#include "util/util.h"
+
+namespace appimage::update {
+    using namespace util;
+
+    namespace {
+        // must be increased whenever the format of the entries changes
+        constexpr int cacheFormatVersion = 2;
+
+        struct Entry {
+            std::string url;
+            std::string etag;
+            std::string lastModified;
+            // some APIs return essential information in headers, e.g., GitHub's Link header used for pagination
+            cpr::Header headers;
+            std::string body;
+        };
+
+        std::string cacheFormatHeader() {
+            return "appimageupdate-http-cache " + std::to_string(cacheFormatVersion);
+        }
+
+        // FNV-1a is not collision resistant, therefore the URL is stored in the entry, and compared when reading it
+        std::string entryName(const std::string& url) {
+            uint64_t hash = 14695981039346656037ULL;
+
+            for (const auto c : url) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ULL;
+            }
+
+            std::ostringstream oss;
+            oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+            return oss.str();
+        }
+
+        std::string headerValue(const cpr::Response& response, const std::string& name) {
+            // cpr compares header names case-insensitively
+            const auto it = response.header.find(name);
+
+            if (it == response.header.end()) {
+                return "";
+            }
+
+            return it->second;
+        }
+
+        bool readEntry(const std::string& path, const std::string& url, Entry& entry) {
+            if (!isPrivateFile(path)) {
+                return false;
+            }
+
+            std::ifstream ifs(path);
+
+            std::string header;
+
+            if (!std::getline(ifs, header) || header != cacheFormatHeader()) {
+                return false;
+            }
+
+            if (!std::getline(ifs, entry.url) || !std::getline(ifs, entry.etag) || !std::getline(ifs, entry.lastModified)) {
+                return false;
+            }
+
+            if (entry.url != url) {
+                return false;
+            }
+
+            std::string headerCountLine;
+            long headerCount;
+
+            if (!std::getline(ifs, headerCountLine) || !toLong(headerCountLine, headerCount) || headerCount < 0) {
+                return false;
+            }
+
+            for (long i = 0; i < headerCount; ++i) {
+                std::string headerLine;
+
+                if (!std::getline(ifs, headerLine)) {
+                    return false;
+                }
+
+                const auto separator = headerLine.find(": ");
+
+                if (separator == std::string::npos) {
+                    return false;
+                }
+
+                entry.headers[headerLine.substr(0, separator)] = headerLine.substr(separator + 2);
+            }
+
+            std::ostringstream body;
+            body << ifs.rdbuf();
+            entry.body = body.str();
+
+            return true;
+        }
+
+        void writeEntry(const std::string& directory, const std::string& path, const Entry& entry) {
+            if (!ensurePrivateDirectory(directory)) {
+                return;
+            }
+
+            std::ostringstream oss;
+            oss << cacheFormatHeader() << std::endl
+                << entry.url << std::endl
+                << entry.etag << std::endl
+                << entry.lastModified << std::endl
+                << entry.headers.size() << std::endl;
+
+            for (const auto& header : entry.headers) {
+                oss << header.first << ": " << header.second << std::endl;
+            }
+
+            oss << entry.body;
+
+            // concurrent readers never see incomplete entries, and failing to store the entry merely causes a cache
+            // miss
+            (void) writePrivateFile(path, oss.str());
+        }
+    }
+
+    HttpCache::HttpCache(std::string directory) : _directory(std::move(directory)) {
+        // without a cache directory, the directory remains empty, which disables the cache
+        if (_directory.empty() && !cacheDirectory().empty()) {
+            _directory = cacheDirectory() + "/http";
+        }
+    }
+
+    cpr::Response HttpCache::get(const std::string& url) const {
+        if (_directory.empty()) {
+            return httpGet(url);
+        }
+
+        const auto entryPath = _directory + "/" + entryName(url);
+
+        // entries in directories other users can write to might have been planted, and must not be used
+        Entry cachedEntry;
+        const bool haveCachedEntry = isPrivateDirectory(_directory) && readEntry(entryPath, url, cachedEntry);
+
+        cpr::Header conditionalHeaders;
+
+        if (haveCachedEntry) {
+            if (!cachedEntry.etag.empty()) {
+                conditionalHeaders["If-None-Match"] = cachedEntry.etag;
+            }
+
+            if (!cachedEntry.lastModified.empty()) {
+                conditionalHeaders["If-Modified-Since"] = cachedEntry.lastModified;
+            }
+        }
+
+        auto response = httpGet(url, conditionalHeaders);
+
+        if (response.error.code != cpr::ErrorCode::OK) {
+            return response;
+        }
+
+        if (haveCachedEntry && response.status_code == 304) {
+            // the headers of the 304 response take precedence over the cached ones
+            for (const auto& header : response.header) {
+                cachedEntry.headers[header.first] = header.second;
+            }
+
+            response.status_code = 200;
+            response.header = cachedEntry.headers;
+            response.text = cachedEntry.body;
+            return response;
+        }
+
+        if (response.status_code == 200) {
+            Entry entry{url, headerValue(response, "ETag"), headerValue(response, "Last-Modified"), response.header, response.text};
+
+            // header values never contain newlines, but better safe than sorry
+            const auto containsNewline = [](const std::string& value) {
+                return value.find('\n') != std::string::npos;
+            };
+
+            const bool headersValid = std::none_of(entry.headers.begin(), entry.headers.end(), [&containsNewline](const auto& header) {
+                return containsNewline(header.first) || containsNewline(header.second);
+            });
+
+            // without validators, the response can't be revalidated, so there is no point in storing it
+            if ((!entry.etag.empty() || !entry.lastModified.empty()) && headersValid && !containsNewline(entry.url)) {
+                writeEntry(_directory, entryPath, entry);
+            }
+        }
+
+        return response;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// system headers
+#include <string>
+
+// library headers
+#include <cpr/cpr.h>
+
+namespace appimage::update {
+    /**
+     * Persistent on-disk cache for HTTP GET requests, e.g., to the APIs used to build the ZSync URLs.
+     *
+     * Responses which carry an ETag or a Last-Modified header are stored, and revalidated with a conditional request
+     * the next time they are requested. If the server responds with 304 Not Modified, the cached response (body and
+     * headers) is used.
+     * Besides saving bandwidth, this keeps periodic update checks well within GitHub's API rate limit, as conditional
+     * requests answered with 304 do not count against it.
+     *
+     * Like HashCache, the cache is strictly best-effort: I/O errors merely result in cache misses.
+     */
+    class HttpCache {
+    private:
+        std::string _directory;
+
+    public:
+        // by default, the cache is stored within cacheDirectory()
+        explicit HttpCache(std::string directory = "");
+
+    public:
+        // performs a GET request, using the cached response if it is still valid
+        // in that case, the status code of the returned response is 200, and its text is the cached body
+        [[nodiscard]] cpr::Response get(const std::string& url) const;
+    };
+}
@@ -0,0 +1,68 @@
+// system headers
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// local headers
+#include "httpsession.h"
+
+namespace appimage::update::util {
+    namespace {
+        // idle sessions beyond this number are discarded, along with their connections
+        constexpr size_t maximumIdleSessions = 8;
+
+        std::mutex poolMutex;
+        std::vector<std::unique_ptr<cpr::Session>> idleSessions;
+
+        // takes a session from the pool for the duration of a request, and puts it back afterwards
+        // a libcurl handle may be used by different threads, but not by multiple threads at once
+        class PooledSession {
+        private:
+            std::unique_ptr<cpr::Session> _session;
+
+        public:
+            PooledSession() {
+                {
+                    std::lock_guard<std::mutex> guard(poolMutex);
+
+                    if (!idleSessions.empty()) {
+                        _session = std::move(idleSessions.back());
+                        idleSessions.pop_back();
+                        return;
+                    }
+                }
+
+                _session = std::make_unique<cpr::Session>();
+                _session->SetHttpVersion(cpr::HttpVersion{cpr::HttpVersionCode::VERSION_2_0_TLS});
+            }
+
+            ~PooledSession() {
+                std::lock_guard<std::mutex> guard(poolMutex);
+
+                if (idleSessions.size() < maximumIdleSessions) {
+                    idleSessions.emplace_back(std::move(_session));
+                }
+            }
+
+            PooledSession(const PooledSession&) = delete;
+            PooledSession& operator=(const PooledSession&) = delete;
+
+            // options set on a session apply to all subsequent requests, so they have to be reset for each request
+            cpr::Session& prepare(const std::string& url, const cpr::Header& headers) {
+                _session->SetUrl(cpr::Url{url});
+                _session->SetHeader(headers);
+                return *_session;
+            }
+        };
+    }
+
+    cpr::Response httpGet(const std::string& url, const cpr::Header& headers) {
+        PooledSession session;
+        return session.prepare(url, headers).Get();
+    }
+
+    cpr::Response httpHead(const std::string& url, const cpr::Header& headers) {
+        PooledSession session;
+        return session.prepare(url, headers).Head();
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// system headers
+#include <string>
+
+// library headers
+#include <cpr/cpr.h>
+
+namespace appimage::update::util {
+    /*
+     * HTTP requests are performed on sessions taken from a process-wide pool, and put back afterwards.
+     *
+     * libcurl caches connections, DNS lookups and TLS sessions per handle, so subsequent requests to the same host,
+     * e.g., to GitHub's API and the release assets, reuse the connection rather than paying for another TLS handshake.
+     * HTTP/2 is negotiated with servers supporting it, falling back to HTTP/1.1 otherwise.
+     *
+     * The pool is shared by all threads. This matters as an Updater performs its update check on the caller's thread,
+     * but the update itself on a thread of its own; thread-local sessions would not be shared between the two. A
+     * session is used by one request at a time only, concurrent requests (e.g., by the workers of a batch update) use
+     * different sessions.
+     */
+
+    // performs a GET request on a pooled session, sending the given headers only
+    cpr::Response httpGet(const std::string& url, const cpr::Header& headers = {});
+
+    // performs a HEAD request on a pooled session, sending the given headers only
+    cpr::Response httpHead(const std::string& url, const cpr::Header& headers = {});
+}
@@ -0,0 +1,257 @@
+// system headers
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// local headers
+#include "resumejournal.h"
+#include "util/util.h"
+
+namespace appimage::update {
+    using namespace util;
+
+    namespace {
+        // must be increased whenever the format of the entries changes
+        constexpr int journalFormatVersion = 1;
+
+        // by then, a newer release has most likely been published, which makes the partial output useless
+        constexpr auto maximumEntryAge = std::chrono::hours(7 * 24);
+
+        struct Entry {
+            std::string appImagePath;
+            std::string zsyncUrl;
+            std::string partialFilePath;
+        };
+
+        std::string journalFormatHeader() {
+            return "appimageupdate-resume-journal " + std::to_string(journalFormatVersion);
+        }
+
+        // FNV-1a is not collision resistant, therefore the AppImage's path is stored in the entry, and compared when
+        // reading it
+        std::string entryName(const std::string& appImagePath) {
+            uint64_t hash = 14695981039346656037ULL;
+
+            for (const auto c : appImagePath) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ULL;
+            }
+
+            std::ostringstream oss;
+            oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+            return oss.str();
+        }
+
+        // record() moves the partial output next to the AppImage if it can't be moved into the journal's directory
+        std::string preservedPathNextToAppImage(const std::string& appImagePath) {
+            const std::filesystem::path appImageFsPath(appImagePath);
+            return (appImageFsPath.parent_path() / ("." + appImageFsPath.filename().string() + ".resume")).string();
+        }
+
+        // the files record() has created at the locations known to the journal may be removed even if they don't pass
+        // isPrivateFile(), e.g., because they were created with the umask's permissions by a previous version
+        void removeOwnFile(const std::string& path) {
+            struct stat st{};
+
+            if (lstat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == geteuid()) {
+                std::remove(path.c_str());
+            }
+        }
+
+        bool isExpired(const std::string& path) {
+            struct stat st{};
+
+            if (lstat(path.c_str(), &st) != 0) {
+                return false;
+            }
+
+            const auto modified = std::chrono::system_clock::from_time_t(st.st_mtim.tv_sec);
+            return std::chrono::system_clock::now() - modified > maximumEntryAge;
+        }
+
+        bool parseEntry(const std::string& path, Entry& entry) {
+            std::ifstream ifs(path);
+
+            std::string header;
+
+            if (!std::getline(ifs, header) || header != journalFormatHeader()) {
+                return false;
+            }
+
+            return std::getline(ifs, entry.appImagePath) && std::getline(ifs, entry.zsyncUrl) &&
+                   std::getline(ifs, entry.partialFilePath);
+        }
+
+        // entries are only trusted if nobody else could have planted them, as the files they refer to are renamed and
+        // deleted on the user's behalf
+        bool readEntry(const std::string& directory, const std::string& path, const std::string& appImagePath, Entry& entry) {
+            if (directory.empty() || !isPrivateDirectory(directory) || !isPrivateFile(path)) {
+                return false;
+            }
+
+            return parseEntry(path, entry) && entry.appImagePath == appImagePath;
+        }
+
+        bool writeEntry(const std::string& path, const Entry& entry) {
+            std::ostringstream oss;
+            oss << journalFormatHeader() << std::endl
+                << entry.appImagePath << std::endl
+                << entry.zsyncUrl << std::endl
+                << entry.partialFilePath << std::endl;
+
+            return writePrivateFile(path, oss.str());
+        }
+
+        bool containsNewline(const std::string& value) {
+            return value.find('\n') != std::string::npos;
+        }
+    }
+
+    ResumeJournal::ResumeJournal(std::string directory) : _directory(std::move(directory)) {
+        // without a cache directory, the directory remains empty, which disables the journal
+        if (_directory.empty() && !cacheDirectory().empty()) {
+            _directory = cacheDirectory() + "/resume";
+        }
+    }
+
+    std::string ResumeJournal::entryPath(const std::string& appImagePath) const {
+        return _directory + "/" + entryName(appImagePath);
+    }
+
+    void ResumeJournal::prune() const {
+        if (!isPrivateDirectory(_directory)) {
+            return;
+        }
+
+        std::vector<std::string> expiredPaths;
+
+        try {
+            for (const auto& file : std::filesystem::directory_iterator(_directory)) {
+                if (isExpired(file.path().string())) {
+                    expiredPaths.emplace_back(file.path().string());
+                }
+            }
+        } catch (const std::filesystem::filesystem_error&) {
+            // whatever has been found so far is pruned, the rest is taken care of next time
+        }
+
+        for (const auto& path : expiredPaths) {
+            const auto fileName = std::filesystem::path(path).filename().string();
+
+            // partial output and temporary files are named after their entry, plus some extension
+            if (fileName.find('.') != std::string::npos) {
+                removeOwnFile(path);
+                continue;
+            }
+
+            Entry entry;
+
+            if (parseEntry(path, entry) && entryName(entry.appImagePath) == fileName) {
+                if (isPrivateFile(path) && isPrivateFile(entry.partialFilePath)) {
+                    std::remove(entry.partialFilePath.c_str());
+                }
+
+                removeOwnFile(preservedPathNextToAppImage(entry.appImagePath));
+            }
+
+            removeOwnFile(path + ".part");
+            removeOwnFile(path);
+        }
+    }
+
+    std::string ResumeJournal::partialFile(const std::string& appImagePath, const std::string& zsyncUrl) const {
+        if (_directory.empty()) {
+            return "";
+        }
+
+        prune();
+
+        const auto path = entryPath(appImagePath);
+
+        Entry entry;
+
+        // the blocks of a different file are of little use, so the space is better freed
+        // the same goes for entries which can't be trusted or refer to files which can't be trusted
+        if (!readEntry(_directory, path, appImagePath, entry) || entry.zsyncUrl != zsyncUrl ||
+            !isPrivateFile(entry.partialFilePath)) {
+            remove(appImagePath);
+            return "";
+        }
+
+        return entry.partialFilePath;
+    }
+
+    bool ResumeJournal::record(const std::string& appImagePath, const std::string& zsyncUrl, const std::string& partialFilePath) const {
+        if (containsNewline(appImagePath) || containsNewline(zsyncUrl)) {
+            return false;
+        }
+
+        // a previous entry is superseded by the new one, which contains all the blocks of the old one anyway
+        remove(appImagePath);
+
+        if (_directory.empty() || !ensurePrivateDirectory(_directory)) {
+            return false;
+        }
+
+        prune();
+
+        const auto path = entryPath(appImagePath);
+
+        // zsync would overwrite the partial output on its next run, so it has to be moved
+        // the cache directory might reside on a different filesystem, in which case it is kept next to the AppImage
+        // copying it would take about as long as downloading it again on fast connections
+        auto preservedPath = path + ".part";
+
+        if (std::rename(partialFilePath.c_str(), preservedPath.c_str()) != 0) {
+            preservedPath = preservedPathNextToAppImage(appImagePath);
+
+            if (std::rename(partialFilePath.c_str(), preservedPath.c_str()) != 0) {
+                return false;
+            }
+        }
+
+        // zsync creates the partial output with the permissions the umask permits, but only private files are trusted
+        // by partialFile()
+        // in case the file can't be recorded, it is put back where zsync has left it
+        if (chmod(preservedPath.c_str(), 0600) != 0 || !writeEntry(path, {appImagePath, zsyncUrl, preservedPath})) {
+            if (std::rename(preservedPath.c_str(), partialFilePath.c_str()) != 0) {
+                std::remove(preservedPath.c_str());
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    void ResumeJournal::remove(const std::string& appImagePath) const {
+        if (_directory.empty()) {
+            return;
+        }
+
+        const auto path = entryPath(appImagePath);
+
+        Entry entry;
+
+        if (readEntry(_directory, path, appImagePath, entry)) {
+            if (isPrivateFile(entry.partialFilePath)) {
+                std::remove(entry.partialFilePath.c_str());
+            }
+        } else if (!isPrivateDirectory(_directory)) {
+            return;
+        }
+
+        // entries which can't be read (e.g., because they are not private) may still have partial output at the
+        // locations record() uses, which would remain there forever otherwise
+        removeOwnFile(path + ".part");
+        removeOwnFile(preservedPathNextToAppImage(appImagePath));
+        removeOwnFile(path);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// system headers
+#include <string>
+
+namespace appimage::update {
+    /**
+     * Keeps track of the partial output of updates which failed, e.g., because the connection was lost, so that the
+     * next update of the same AppImage from the same URL can continue where the previous one stopped.
+     *
+     * zsync writes the blocks it has obtained so far to their final positions in the partial output. Using the
+     * preserved file as an additional seed therefore makes zsync reuse all of those blocks, and only the remaining
+     * ones are downloaded.
+     *
+     * There is at most one entry per AppImage. Entries for a different URL (e.g., because a newer release has been
+     * published in the meantime) are discarded along with their partial output. So are entries older than a week, as
+     * nothing else would clean up after AppImages which are never updated again.
+     *
+     * Like HashCache, the journal is strictly best-effort: I/O errors merely result in updates starting from scratch.
+     */
+    class ResumeJournal {
+    private:
+        std::string _directory;
+
+        [[nodiscard]] std::string entryPath(const std::string& appImagePath) const;
+
+        // removes expired entries along with their partial output
+        void prune() const;
+
+    public:
+        // by default, the journal is stored within cacheDirectory()
+        explicit ResumeJournal(std::string directory = "");
+
+    public:
+        // returns the preserved partial output of a previous update of the AppImage from the given URL
+        // returns an empty string if there is none
+        [[nodiscard]] std::string partialFile(const std::string& appImagePath, const std::string& zsyncUrl) const;
+
+        // moves the partial output of a failed update out of zsync's way and records it
+        // returns false if the file could not be preserved
+        bool record(const std::string& appImagePath, const std::string& zsyncUrl, const std::string& partialFilePath) const;
+
+        // discards the entry for the AppImage along with the partial output, e.g., after a successful update
+        void remove(const std::string& appImagePath) const;
+    };
+}
@@ -0,0 +1,74 @@
+// system headers
+#include <stdexcept>
+#include <utility>
+
+// local headers
+#include "statusmessagequeue.h"
+
+namespace {
+    typedef std::lock_guard<std::mutex> lock_guard;
+}
+
+namespace appimage::update {
+    StatusMessageQueue::StatusMessageQueue(std::size_t capacity) : _head(0), _size(0), _pushedCount(0), _droppedCount(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("capacity of status message queue must not be 0");
+        }
+
+        _buffer.resize(capacity);
+    }
+
+    bool StatusMessageQueue::push(std::string message) {
+        lock_guard guard(_mutex);
+
+        ++_pushedCount;
+
+        if (_size == _buffer.size()) {
+            // overwrite the oldest message
+            _buffer[_head] = std::move(message);
+            _head = (_head + 1) % _buffer.size();
+            ++_droppedCount;
+            return false;
+        }
+
+        _buffer[(_head + _size) % _buffer.size()] = std::move(message);
+        ++_size;
+        return true;
+    }
+
+    bool StatusMessageQueue::pop(std::string& message) {
+        lock_guard guard(_mutex);
+
+        if (_size == 0) {
+            return false;
+        }
+
+        message = std::move(_buffer[_head]);
+
+        // release the memory right away
+        _buffer[_head] = std::string();
+
+        _head = (_head + 1) % _buffer.size();
+        --_size;
+        return true;
+    }
+
+    std::size_t StatusMessageQueue::size() const {
+        lock_guard guard(_mutex);
+        return _size;
+    }
+
+    std::size_t StatusMessageQueue::capacity() const {
+        return _buffer.size();
+    }
+
+    unsigned long long StatusMessageQueue::pushedCount() const {
+        lock_guard guard(_mutex);
+        return _pushedCount;
+    }
+
+    unsigned long long StatusMessageQueue::droppedCount() const {
+        lock_guard guard(_mutex);
+        return _droppedCount;
+    }
+}
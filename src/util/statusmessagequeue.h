@@ -0,0 +1,51 @@
+#pragma once
+
+// system headers
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace appimage::update {
+    /**
+     * Bounded queue for status messages, safe to be used by multiple producer and consumer threads.
+     *
+     * Messages are stored in a ring buffer of fixed capacity. When the queue is full, the oldest message is dropped
+     * in favor of the new one, so that a long-running update cannot consume an arbitrary amount of memory if nobody
+     * fetches the messages.
+     */
+    class StatusMessageQueue {
+    public:
+        static constexpr std::size_t defaultCapacity = 1024;
+
+    private:
+        mutable std::mutex _mutex;
+
+        std::vector<std::string> _buffer;
+
+        // index of the oldest message, and number of messages in the buffer
+        std::size_t _head;
+        std::size_t _size;
+
+        unsigned long long _pushedCount;
+        unsigned long long _droppedCount;
+
+    public:
+        // throws std::invalid_argument if capacity is 0
+        explicit StatusMessageQueue(std::size_t capacity = defaultCapacity);
+
+    public:
+        // returns false if the oldest message had to be dropped to make room for the new one
+        bool push(std::string message);
+
+        // returns false if the queue is empty
+        bool pop(std::string& message);
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t capacity() const;
+
+        // total number of messages pushed into and dropped from the queue
+        [[nodiscard]] unsigned long long pushedCount() const;
+        [[nodiscard]] unsigned long long droppedCount() const;
+    };
+}
@@ -1,58 +1,30 @@
+// system headers
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
 // library headers
-#include <appimage/appimage_shared.h>
 #include <zshash.h>
 
 // local headers
 #include "updatableappimage.h"
+#include "util/appimagemetadata.h"
 #include "updateinformation/updateinformation.h"
 #include "util/util.h"
 
 namespace appimage::update {
     using namespace updateinformation;
     using namespace util;
-    using namespace zsync2;
 
-    void UpdatableAppImage::assertIfstreamGood(const std::ifstream& ifs) const {
-        if (!ifs || !ifs.good()) {
-            throw AppImageError("Error while opening/accessing/reading from AppImage: " + _path);
+    const AppImageMetadata& UpdatableAppImage::metadata() const {
+        if (_metadata == nullptr) {
+            _metadata = std::make_shared<const AppImageMetadata>(_path);
         }
-    }
 
-    std::ifstream UpdatableAppImage::_open() const  {
-        // check whether file exists
-        std::ifstream ifs(_path);
-        assertIfstreamGood(ifs);
-        return ifs;
-    }
-
-    bool UpdatableAppImage::_hasElfMagicValue(std::ifstream& ifs) const {
-        static constexpr int elfMagicPos = 0;
-        static const std::string elfMagicValue = "\7ELF";
-
-        ifs.seekg(elfMagicPos);
-        assertIfstreamGood(ifs);
-
-        std::vector<char> elfMagicPosData(elfMagicValue.size() + 1, '\0');
-
-        ifs.read(elfMagicPosData.data(), elfMagicValue.size());
-        assertIfstreamGood(ifs);
-
-        return elfMagicPosData.data() == elfMagicValue;
-    }
-
-    bool UpdatableAppImage::_hasIsoMagicValue(std::ifstream& ifs) const {
-        static constexpr int isoMagicPos = 32769;
-        static const std::string isoMagicValue = "CD001";
-
-        ifs.seekg(isoMagicPos);
-        assertIfstreamGood(ifs);
-
-        std::vector<char> isoMagicPosData(isoMagicValue.size() + 1, '\0');
-
-        ifs.read(isoMagicPosData.data(), isoMagicValue.size());
-        assertIfstreamGood(ifs);
-
-        return isoMagicPosData.data() == isoMagicValue;
+        return *_metadata;
     }
 
     UpdatableAppImage::UpdatableAppImage(std::string path) : _path(std::move(path)) {}
@@ -62,26 +34,23 @@ namespace appimage::update {
     }
 
     int UpdatableAppImage::appImageType() const {
-        auto ifs = _open();
-
-        // read magic number
-        ifs.seekg(8, std::ios::beg);
-        assertIfstreamGood(ifs);
+        const auto& appImageMetadata = metadata();
 
-        std::vector<char> magicByte(4, '\0');
+        const auto& magicBytes = appImageMetadata.magicBytes();
 
-        ifs.read(magicByte.data(), 3);
-        assertIfstreamGood(ifs);
+        if (magicBytes.size() < 3) {
+            throw AppImageError("Error while opening/accessing/reading from AppImage: " + _path);
+        }
 
         // validate first two bytes are A and I
-        if (magicByte[0] != 'A' && magicByte[1] != 'I') {
+        if (magicBytes[0] != 'A' && magicBytes[1] != 'I') {
             std::ostringstream oss;
-            oss << "Invalid magic bytes: " << (int) magicByte[0] << (int) magicByte[1];
+            oss << "Invalid magic bytes: " << (int) magicBytes[0] << (int) magicBytes[1];
             throw AppImageError(oss.str());
         }
 
         // for types 1 and 2, the third byte contains the type ID
-        auto appImageType = magicByte[2];
+        auto appImageType = magicBytes[2];
 
         if (appImageType >= 1 && appImageType <= 2) {
             return appImageType;
@@ -90,7 +59,7 @@ namespace appimage::update {
         // final try: type 1 AppImages do not have to set the magic bytes, although they should
         // if the file is both an ELF and an ISO9660 file, we'll suspect it to be a type 1 AppImage, and
         // proceed with a warning
-        if (_hasElfMagicValue(ifs) && _hasIsoMagicValue(ifs)) {
+        if (appImageMetadata.hasElfMagicValue() && appImageMetadata.hasIsoMagicValue()) {
             return 1;
         }
 
@@ -104,7 +73,7 @@ namespace appimage::update {
             throw AppImageError("Signature reading is not supported for type " + std::to_string(type));
         }
 
-        return readElfSection(_path, ".sha256_sig");
+        return std::string(metadata().elfSection(".sha256_sig").contents);
     }
 
     std::string UpdatableAppImage::readSigningKey() const {
@@ -114,11 +83,11 @@ namespace appimage::update {
             throw AppImageError("Reading signing key is not supported for type " + std::to_string(type));
         }
 
-        return readElfSection(_path, ".sig_key");
+        return std::string(metadata().elfSection(".sig_key").contents);
     }
 
     std::string UpdatableAppImage::readRawUpdateInformation() const {
-        auto ifs = _open();
+        const auto& appImageMetadata = metadata();
 
         int type;
         try {
@@ -127,7 +96,7 @@ namespace appimage::update {
             // in case the ISO magic bytes can be found, we treat this file like a type 1 AppImage in this
             // special case
             // this is legacy behavior adopted from the current AppImageUpdate's predecessor
-            if (_hasIsoMagicValue(ifs)) {
+            if (appImageMetadata.hasIsoMagicValue()) {
                 type = 1;
             } else {
                 std::rethrow_exception(std::current_exception());
@@ -136,151 +105,133 @@ namespace appimage::update {
 
         if (type == 1) {
             // update information is always at the same position, and has a fixed length
-            static constexpr auto position = 0x8373;
-            static constexpr auto length = 512;
-
-            ifs.seekg(position);
-
-            std::vector<char> rawUpdateInformation(length, 0);
-            ifs.read(rawUpdateInformation.data(), length);
-
-            return rawUpdateInformation.data();
+            return appImageMetadata.type1UpdateInformation();
         }
 
         if (type == 2) {
             // try to read ELF section .upd_info
-            return readElfSection(_path, ".upd_info");
+            return std::string(appImageMetadata.elfSection(".upd_info").contents);
         }
 
         // should be unreachable
         throw AppImageError("Reading update information not supported for type " + std::to_string(type));
     }
 
-    std::string UpdatableAppImage::calculateHash() const {
-        // read offset and length of signature section to skip it later
-        unsigned long sigOffset = 0, sigLength = 0;
-        unsigned long keyOffset = 0, keyLength = 0;
+    void UpdatableAppImage::readChunks(
+        const std::function<void(std::vector<char>&)>& processChunk,
+        const std::vector<std::pair<off_t, off_t>>& excludedRanges
+    ) const {
+        const auto& appImageMetadata = metadata();
 
-        if (!appimage_get_elf_section_offset_and_length(_path.c_str(), ".sha256_sig", &sigOffset, &sigLength)) {
-            throw AppImageError("Could not find .sha256_sig section in AppImage");
-        }
+        // we read from the file descriptor the metadata have been parsed from, which makes sure we hash the very
+        // same file even if it has been replaced on disk in the meantime
+        const auto fd = appImageMetadata.fd();
+        const auto fileSize = appImageMetadata.fileSize();
 
-        if (!appimage_get_elf_section_offset_and_length(_path.c_str(), ".sig_key", &keyOffset, &keyLength)) {
-            throw AppImageError("Could not find .sig_key section in AppImage");
-        }
-
-        auto ifs = _open();
+        // the whole file is read front to back exactly once, so we can tell the kernel to read ahead aggressively
+        // this is merely a hint, therefore errors can be ignored safely
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
-        ZSyncHash<GCRY_MD_SHA256> digest;
+        const auto readSpan = [this, fd](char* data, off_t offset, size_t length) {
+            size_t bytesRead = 0;
 
-        // validate.c uses "offset" as chunk size, but that value might be quite high, and therefore uses
-        // a lot of memory
-        // TODO: use a smaller value (maybe use a prime factorization and use the biggest prime factor?)
-        const std::streamsize chunkSize = 4096;
+            while (bytesRead < length) {
+                const auto rv = pread(fd, data + bytesRead, length - bytesRead, offset + static_cast<off_t>(bytesRead));
 
-        std::vector<char> buffer(chunkSize, 0);
-
-        ssize_t totalBytesRead = 0;
+                if (rv < 0 && errno == EINTR) {
+                    continue;
+                }
 
-        // bytes that should be skipped when reading the next chunk
-        // when e.g., a section that must be ignored spans over more than one chunk, this amount of bytes is
-        // being nulled & skipped before reading data from the file again
-        std::streamsize bytesToSkip = 0;
+                if (rv <= 0) {
+                    throw AppImageError("Error while opening/accessing/reading from AppImage: " + _path);
+                }
 
-        ifs.seekg(0, std::ios::end);
-        assertIfstreamGood(ifs);
-        const ssize_t fileSize = ifs.tellg();
-        assertIfstreamGood(ifs);
-        ifs.seekg(0, std::ios::beg);
-        assertIfstreamGood(ifs);
+                bytesRead += rv;
+            }
+        };
 
-        while (ifs) {
-            // in case we read less bytes than the chunk size, we resize the vector to the number of bytes read
-            // we have to reset this upon the next iteration
-            // this should be a no-op when the size has not changed, and should not be necessary, as the only time
-            // we receive less bytes than requested should be the final read call
-            buffer.resize(chunkSize);
+        // large enough to keep the number of syscalls low, small enough not to matter memory-wise
+        static constexpr off_t chunkSize = 1024 * 1024;
 
-            std::streamsize bytesRead = 0;
+        std::vector<char> buffer;
+        buffer.reserve(chunkSize);
 
-            auto bytesLeftInChunk = std::min(chunkSize, (fileSize - totalBytesRead));
+        off_t position = 0;
 
-            if (bytesLeftInChunk <= 0)
-                break;
+        while (position < fileSize) {
+            buffer.resize(std::min(chunkSize, fileSize - position));
 
-            auto skipBytes = [&bytesRead, &bytesLeftInChunk, &buffer, &ifs, &totalBytesRead, this](ssize_t count) {
-                if (count <= 0)
-                    return;
+            const auto chunkEnd = position + static_cast<off_t>(buffer.size());
 
-                const auto start = buffer.begin() + static_cast<long>(bytesRead);
-                std::fill_n(start, count, '\0');
+            // the chunk is read in spans around the excluded ranges, which are filled with null bytes instead
+            for (off_t spanBegin = position; spanBegin < chunkEnd;) {
+                auto spanEnd = chunkEnd;
+                bool excluded = false;
 
-                bytesRead += count;
-                totalBytesRead += count;
-                bytesLeftInChunk -= count;
+                for (const auto& [rangeBegin, rangeEnd] : excludedRanges) {
+                    if (rangeBegin <= spanBegin && spanBegin < rangeEnd) {
+                        excluded = true;
+                        spanEnd = std::min(rangeEnd, chunkEnd);
+                        break;
+                    }
 
-                ifs.seekg(count, std::ios::cur);
-                assertIfstreamGood(ifs);
-            };
+                    if (spanBegin < rangeBegin && rangeBegin < spanEnd) {
+                        spanEnd = rangeBegin;
+                    }
+                }
 
-            auto readBytes = [&bytesRead, &bytesLeftInChunk, &buffer, &ifs, &totalBytesRead, this](ssize_t count) {
-                if (count <= 0)
-                    return;
+                auto* spanData = buffer.data() + (spanBegin - position);
+                const auto spanLength = static_cast<size_t>(spanEnd - spanBegin);
 
-                ifs.read(buffer.data() + bytesRead, count);
+                if (excluded) {
+                    std::fill(spanData, spanData + spanLength, '\0');
+                } else {
+                    readSpan(spanData, spanBegin, spanLength);
+                }
 
-                bytesRead += ifs.gcount();
-                assertIfstreamGood(ifs);
+                spanBegin = spanEnd;
+            }
 
-                totalBytesRead += count;
-                bytesLeftInChunk -= bytesRead;
-            };
+            position = chunkEnd;
 
-            auto checkSkipSection = [&](const std::streamsize sectionOffset, const std::streamsize sectionLength) {
-                // check whether signature starts in current chunk
-                const auto sectionOffsetDelta = sectionOffset - totalBytesRead;
+            processChunk(buffer);
+        }
+    }
 
-                if (sectionOffsetDelta >= 0 && sectionOffsetDelta < bytesLeftInChunk) {
-                    // read until section begins
-                    readBytes(sectionOffsetDelta);
+    std::string UpdatableAppImage::calculateHash() const {
+        const auto& appImageMetadata = metadata();
 
-                    // calculate how many bytes must be nulled in this chunk
-                    // the rest will be nulled in the following chunk(s)
-                    auto bytesLeft = sectionLength;
-                    const auto bytesToNullInCurrentChunk = std::min(bytesLeftInChunk, bytesLeft);
+        // read offset and length of signature section to skip it later
+        const auto sigSection = appImageMetadata.elfSection(".sha256_sig");
+        const auto keySection = appImageMetadata.elfSection(".sig_key");
 
-                    // null these bytes
-                    skipBytes(bytesToNullInCurrentChunk);
+        if (!sigSection.found) {
+            throw AppImageError("Could not find .sha256_sig section in AppImage");
+        }
 
-                    // calculate how many bytes must be nulled in future chunks
-                    bytesLeft -= bytesToNullInCurrentChunk;
-                    bytesToSkip = bytesLeft;
-                }
-            };
+        if (!keySection.found) {
+            throw AppImageError("Could not find .sig_key section in AppImage");
+        }
 
-            // check whether bytes must be skipped from previous sections
-            if (bytesToSkip > 0) {
-                auto bytesToSkipInCurrentChunk = std::min(chunkSize, bytesToSkip);
-                skipBytes(bytesToSkipInCurrentChunk);
-                bytesToSkip -= bytesToSkipInCurrentChunk;
-            }
+        // the signature and key sections are hashed as if they were filled with null bytes, so they don't need to be read
+        zsync2::ZSyncHash<GCRY_MD_SHA256> digest;
 
-            // check whether one of the sections that must be skipped are in the current chunk, and if they
-            // are, skip those sections in the current and future sections
-            checkSkipSection(static_cast<std::streamsize>(sigOffset), static_cast<std::streamsize>(sigLength));
-            checkSkipSection(static_cast<std::streamsize>(keyOffset), static_cast<std::streamsize>(keyLength));
+        readChunks([&digest](std::vector<char>& chunk) {
+            digest.add(chunk);
+        }, {
+            {static_cast<off_t>(sigSection.offset), static_cast<off_t>(sigSection.offset + sigSection.length)},
+            {static_cast<off_t>(keySection.offset), static_cast<off_t>(keySection.offset + keySection.length)},
+        });
 
-            // read remaining bytes in chunk, given the file has still data to be read
-            if (ifs && bytesLeftInChunk > 0) {
-                readBytes(bytesLeftInChunk);
-            }
+        return digest.getHash();
+    }
 
-            // make sure the buffer has the right size
-            buffer.resize(bytesRead);
+    std::string UpdatableAppImage::calculateSha1Hash() const {
+        zsync2::ZSyncHash<GCRY_MD_SHA1> digest;
 
-            // update hash with data from buffer
-            digest.add(buffer);
-        }
+        readChunks([&digest](std::vector<char>& chunk) {
+            digest.add(chunk);
+        });
 
         return digest.getHash();
     }
@@ -1,32 +1,47 @@
 #pragma once
 
 // system headers
-#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
 #include <utility>
+#include <vector>
 
 namespace appimage::update {
     class AppImageError : public std::runtime_error {
         using std::runtime_error::runtime_error;
     };
 
+    class AppImageMetadata;
+
+    // note: instances are not thread-safe, as the metadata are parsed lazily on first access
+    // once the metadata have been parsed, i.e., metadata() has been called, copies of the instance may be used
+    // concurrently, as they share the same immutable metadata
     class UpdatableAppImage {
     private:
         std::string _path;
 
-    private:
-        void assertIfstreamGood(const std::ifstream& ifs) const;
-
-        [[nodiscard]] std::ifstream _open() const;
-
-        bool _hasElfMagicValue(std::ifstream& ifs) const;
+        // parsed on first access, and reused by all the accessors below
+        mutable std::shared_ptr<const AppImageMetadata> _metadata;
 
-        bool _hasIsoMagicValue(std::ifstream& ifs) const;
+    private:
+        // reads the entire file front to back, passing it to the callback in chunks
+        // the [begin, end) byte ranges passed as excludedRanges are not read, but passed as null bytes
+        void readChunks(
+            const std::function<void(std::vector<char>& chunk)>& processChunk,
+            const std::vector<std::pair<off_t, off_t>>& excludedRanges = {}
+        ) const;
 
     public:
         explicit UpdatableAppImage(std::string path);
 
         [[nodiscard]] std::string path() const;
 
+        // parses the file on first access, throws AppImageError if the file cannot be read
+        [[nodiscard]] const AppImageMetadata& metadata() const;
+
         [[nodiscard]] int appImageType() const;
 
         [[nodiscard]] std::string readSignature() const;
@@ -36,5 +51,8 @@ namespace appimage::update {
         [[nodiscard]] std::string readRawUpdateInformation() const;
 
         [[nodiscard]] std::string calculateHash() const;
+
+        // SHA-1 digest of the entire file, as used by zsync to check whether a file is up to date
+        [[nodiscard]] std::string calculateSha1Hash() const;
     };
 }
@@ -1,5 +1,7 @@
 // system header
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <climits>
 #include <cstring>
 #include <fstream>
@@ -7,7 +9,10 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -17,12 +22,9 @@
 #endif
 #include <zsutil.h>
 
-// AppImageKit includes
-extern "C" {
-    #include "appimage/appimage_shared.h"
-}
-
 // local header
+#include "util/elfsectionindex.h"
+#include "util/filedescriptor.h"
 #include "util/util.h"
 
 namespace appimage::update::util {
@@ -175,20 +177,24 @@ namespace appimage::update::util {
     }
 
     std::string readElfSection(const std::string& filePath, const std::string& sectionName) {
-        unsigned long offset = 0, length = 0;
+        FileDescriptor fd(open(filePath.c_str(), O_RDONLY | O_CLOEXEC));
 
-        auto rv = appimage_get_elf_section_offset_and_length(filePath.c_str(), sectionName.c_str(), &offset, &length);
+        struct stat st{};
 
-        if (!rv || offset == 0 || length == 0)
+        if (fd.get() < 0 || fstat(fd.get(), &st) != 0)
             return "";
 
-        std::ifstream ifs(filePath);
-        ifs.seekg(offset);
+        const ElfSectionIndex index(fd.get(), st.st_size);
+
+        ElfSectionIndex::Section section;
 
-        std::vector<char> buffer(length+1, 0);
-        ifs.read(buffer.data(), length);
+        // sections occupying no space in the file (SHT_NOBITS) have no contents
+        if (!index.find(sectionName, section) || section.offset == 0 || section.length == 0 || section.noBits)
+            return "";
+
+        const auto data = index.data(sectionName);
 
-        return buffer.data();
+        return {data.data(), strnlen(data.data(), data.size())};
     }
 
     std::string findInPATH(const std::string& name) {
@@ -281,4 +287,228 @@ namespace appimage::update::util {
         buffer.emplace_back('\0');
         return buffer;
     }
+
+    std::string applicationNameFromFileName(const std::string& fileName) {
+        auto name = toLower(fileName);
+
+        static const std::string extension = ".appimage";
+        if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+            name.resize(name.size() - extension.size());
+        }
+
+        // architecture names such as x86_64 contain digits, too, but don't belong to the version
+        static const std::vector<std::string> architectures{"x86_64", "x86-64", "amd64", "i386", "i686", "aarch64", "arm64", "armhf"};
+
+        // the positions of the architecture names in the file name
+        std::vector<std::pair<size_t, size_t>> architectureRanges;
+
+        for (const auto& architecture : architectures) {
+            for (auto pos = name.find(architecture); pos != std::string::npos; pos = name.find(architecture, pos + 1)) {
+                architectureRanges.emplace_back(pos, pos + architecture.size());
+            }
+        }
+
+        const auto isPartOfArchitecture = [&architectureRanges](size_t i) {
+            return std::any_of(architectureRanges.begin(), architectureRanges.end(), [i](const std::pair<size_t, size_t>& range) {
+                return i >= range.first && i < range.second;
+            });
+        };
+
+        // the version is separated from the name by a dash, underscore, space or dot, and starts with a digit
+        for (size_t i = 1; i + 1 < name.size(); ++i) {
+            if (std::strchr("-_ .", name[i]) != nullptr && std::isdigit(static_cast<unsigned char>(name[i + 1])) && !isPartOfArchitecture(i)) {
+                return name.substr(0, i);
+            }
+        }
+
+        // unversioned file names, e.g., appimagetool-x86_64.AppImage, may still end in an architecture name
+        for (const auto& range : architectureRanges) {
+            if (range.first > 1 && range.second == name.size() && std::strchr("-_ .", name[range.first - 1]) != nullptr) {
+                return name.substr(0, range.first - 1);
+            }
+        }
+
+        return name;
+    }
+
+    std::vector<std::string> selectSiblingSeedFiles(
+        const std::string& pathToAppImage,
+        const std::vector<std::string>& candidates
+    ) {
+        static constexpr size_t maximumCount = 8;
+
+        const auto fileNameOf = [](const std::string& path) {
+            return path.substr(path.rfind('/') + 1);
+        };
+
+        const auto appImagePath = abspath(pathToAppImage);
+        const auto fileName = fileNameOf(appImagePath);
+        const auto applicationName = applicationNameFromFileName(fileName);
+
+        // zsync reads every seed entirely, so unrelated AppImages would only cost time
+        std::vector<std::string> siblings;
+
+        for (const auto& candidate : candidates) {
+            const auto candidatePath = abspath(candidate);
+
+            if (candidatePath != appImagePath && applicationNameFromFileName(fileNameOf(candidatePath)) == applicationName) {
+                siblings.emplace_back(candidatePath);
+            }
+        }
+
+        // versions closer to the current one share most of their file name, and most of their blocks
+        const auto commonPrefixLength = [&fileName, &fileNameOf](const std::string& siblingPath) {
+            const auto siblingFileName = fileNameOf(siblingPath);
+            const auto mismatch = std::mismatch(fileName.begin(), fileName.end(), siblingFileName.begin(), siblingFileName.end());
+            return std::distance(fileName.begin(), mismatch.first);
+        };
+
+        std::stable_sort(siblings.begin(), siblings.end(), [&commonPrefixLength](const std::string& a, const std::string& b) {
+            return commonPrefixLength(a) > commonPrefixLength(b);
+        });
+
+        if (siblings.size() > maximumCount) {
+            siblings.resize(maximumCount);
+        }
+
+        return siblings;
+    }
+
+    std::string cacheDirectory() {
+        std::ostringstream oss;
+
+        const auto* xdgCacheHome = getenv("XDG_CACHE_HOME");
+
+        if (xdgCacheHome != nullptr && xdgCacheHome[0] == '/') {
+            oss << xdgCacheHome;
+        } else {
+            const auto* home = getenv("HOME");
+
+            // without any sensible home directory, there is no place to cache data
+            // shared locations such as /tmp are out of question, as other users could plant entries there
+            if (home == nullptr || home[0] != '/') {
+                return "";
+            }
+
+            oss << home << "/.cache";
+        }
+
+        oss << "/appimageupdate";
+
+        return oss.str();
+    }
+
+    namespace {
+        // the directory must be owned by the current user (or root, in case of its parent), and must not be writable
+        // by anyone else, otherwise other users could plant or replace files in it
+        bool isPrivateDirectoryEntry(const std::string& path, bool allowRoot) {
+            struct stat st{};
+
+            if (lstat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+                return false;
+            }
+
+            if (st.st_uid != geteuid() && !(allowRoot && st.st_uid == 0)) {
+                return false;
+            }
+
+            return (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+        }
+
+        std::string parentDirectory(const std::string& path) {
+            const auto separator = path.find_last_of('/');
+
+            if (separator == std::string::npos) {
+                return ".";
+            }
+
+            if (separator == 0) {
+                return "/";
+            }
+
+            return path.substr(0, separator);
+        }
+    }
+
+    bool isPrivateDirectory(const std::string& path) {
+        if (path.empty()) {
+            return false;
+        }
+
+        return isPrivateDirectoryEntry(path, false) && isPrivateDirectoryEntry(parentDirectory(path), true);
+    }
+
+    bool ensurePrivateDirectory(const std::string& path) {
+        if (path.empty() || path[0] != '/') {
+            return false;
+        }
+
+        // create missing directories one by one, so that all of them are accessible by the current user only
+        for (auto separator = path.find('/', 1); ; separator = path.find('/', separator + 1)) {
+            const auto component = path.substr(0, separator);
+
+            if (mkdir(component.c_str(), 0700) != 0 && errno != EEXIST) {
+                return false;
+            }
+
+            if (separator == std::string::npos) {
+                break;
+            }
+        }
+
+        return isPrivateDirectory(path);
+    }
+
+    bool isPrivateFile(const std::string& path) {
+        struct stat st{};
+
+        // symlinks are not followed, they could point anywhere
+        if (lstat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            return false;
+        }
+
+        return st.st_uid == geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+    }
+
+    bool writePrivateFile(const std::string& path, const std::string& contents) {
+        // the temporary file's name must be unique among all the processes and threads which might write the same file
+        std::ostringstream oss;
+        oss << path << ".tmp-" << getpid() << "-" << std::hash<std::thread::id>()(std::this_thread::get_id());
+        const auto tempPath = oss.str();
+
+        // a leftover of a crashed process which happened to have the same PID would make O_EXCL fail
+        unlink(tempPath.c_str());
+
+        {
+            // the mode is passed explicitly, as files created with the default mode would be writable by the group
+            // with umask 002 (the default on systems using user private groups), and isPrivateFile() rejects those
+            FileDescriptor fd(open(tempPath.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600));
+
+            if (fd.get() < 0) {
+                return false;
+            }
+
+            for (size_t bytesWritten = 0; bytesWritten < contents.size();) {
+                const auto rv = write(fd.get(), contents.data() + bytesWritten, contents.size() - bytesWritten);
+
+                if (rv < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (rv <= 0) {
+                    unlink(tempPath.c_str());
+                    return false;
+                }
+
+                bytesWritten += rv;
+            }
+        }
+
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            unlink(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
 }
@@ -42,4 +42,40 @@ namespace appimage::update::util {
     std::string ailfsRealpath(const std::string& path);
 
     std::vector<char> makeBuffer(const std::string& str);
+
+    // Returns the name of the application an AppImage belongs to in lower case, derived from its file name, i.e., the
+    // part before the first version number (e.g., "krita" for "Krita-5.2.0-x86_64.AppImage"). Architecture names are
+    // not mistaken for version numbers, and are removed from unversioned file names (e.g., "appimagetool" for
+    // "appimagetool-x86_64.AppImage").
+    std::string applicationNameFromFileName(const std::string& fileName);
+
+    // Selects the AppImages from the candidates which are other versions of the same application, i.e., share the same
+    // application name (see above). Those with the most similar file names come first. As zsync has to read seed files
+    // entirely, their number is limited.
+    std::vector<std::string> selectSiblingSeedFiles(
+        const std::string& pathToAppImage,
+        const std::vector<std::string>& candidates
+    );
+
+    // Returns AppImageUpdate's cache directory, i.e., $XDG_CACHE_HOME/appimageupdate (or ~/.cache/appimageupdate).
+    // The directory is not created by this function. Returns an empty string if neither variable is set, in which case
+    // nothing must be cached.
+    std::string cacheDirectory();
+
+    // Returns true if the directory is owned by the current user and not writable by others, and the same applies to
+    // its parent directory (which may be owned by root as well). Only the contents of such directories can be trusted.
+    bool isPrivateDirectory(const std::string& path);
+
+    // Creates the given absolute path, including missing parents, accessible by the current user only.
+    // Returns true if the directory is a private directory (see above) afterwards.
+    bool ensurePrivateDirectory(const std::string& path);
+
+    // Returns true if the path refers to a regular file (not a symlink) owned by the current user and not writable by
+    // others.
+    bool isPrivateFile(const std::string& path);
+
+    // Writes the contents to a temporary file which is then moved to the given path atomically, so concurrent readers
+    // never see incomplete files. The file is accessible by the current user only, regardless of the umask.
+    // Returns false on errors, in which case no file is left behind.
+    bool writePrivateFile(const std::string& path, const std::string& contents);
 };
@@ -0,0 +1,103 @@
+// system headers
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "util/elfsectionindex.h"
+
+using namespace appimage::update;
+
+class ElfSectionIndexTest : public ::testing::Test {
+protected:
+    std::string path;
+
+    void SetUp() override {
+        char pattern[] = "/tmp/appimageupdate-test-XXXXXX";
+        const auto fd = mkstemp(pattern);
+        ASSERT_NE(fd, -1);
+        close(fd);
+
+        path = pattern;
+    }
+
+    void TearDown() override {
+        unlink(path.c_str());
+    }
+
+    void writeFile(const std::vector<char>& contents) const {
+        const auto fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+        ASSERT_NE(fd, -1);
+        ASSERT_EQ(write(fd, contents.data(), contents.size()), static_cast<ssize_t>(contents.size()));
+        close(fd);
+    }
+
+    // ELF64 file consisting of the ELF header and the first section header only
+    // e_shnum is 0, so the section count is read from the first section header's sh_size
+    static std::vector<char> makeElfWithExtendedSectionCount(uint64_t sectionCount) {
+        Elf64_Ehdr ehdr{};
+        std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+        ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+        ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+        ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+        ehdr.e_type = ET_EXEC;
+        ehdr.e_version = EV_CURRENT;
+        ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+        ehdr.e_shoff = sizeof(Elf64_Ehdr);
+        ehdr.e_shentsize = sizeof(Elf64_Shdr);
+        ehdr.e_shnum = 0;
+        ehdr.e_shstrndx = 0;
+
+        Elf64_Shdr firstHeader{};
+        firstHeader.sh_size = sectionCount;
+
+        std::vector<char> contents(sizeof(ehdr) + sizeof(firstHeader));
+        std::memcpy(contents.data(), &ehdr, sizeof(ehdr));
+        std::memcpy(contents.data() + sizeof(ehdr), &firstHeader, sizeof(firstHeader));
+
+        return contents;
+    }
+
+    [[nodiscard]] bool indexIsEmpty() const {
+        const auto fd = open(path.c_str(), O_RDONLY);
+
+        if (fd == -1) {
+            ADD_FAILURE() << "could not open " << path;
+            return false;
+        }
+
+        const auto fileSize = lseek(fd, 0, SEEK_END);
+        const ElfSectionIndex index(fd, fileSize);
+        close(fd);
+
+        return index.empty();
+    }
+};
+
+// the crafted headers are written in the host's byte order, but declare to be little endian
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+TEST_F(ElfSectionIndexTest, HugeExtendedSectionCountIsRejected) {
+    // large enough to overflow the size of the section header table, and to make any allocation fail
+    writeFile(makeElfWithExtendedSectionCount(uint64_t(1) << 58));
+
+    EXPECT_TRUE(indexIsEmpty());
+}
+
+TEST_F(ElfSectionIndexTest, ExtendedSectionCountExceedingFileIsRejected) {
+    writeFile(makeElfWithExtendedSectionCount(2));
+
+    EXPECT_TRUE(indexIsEmpty());
+}
+#endif
+
+TEST_F(ElfSectionIndexTest, NonElfFileResultsInEmptyIndex) {
+    writeFile({'n', 'o', 't', ' ', 'a', 'n', ' ', 'E', 'L', 'F', ' ', 'f', 'i', 'l', 'e'});
+
+    EXPECT_TRUE(indexIsEmpty());
+}
@@ -0,0 +1,86 @@
+// system headers
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+#include <thread>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "util/hashcache.h"
+#include "util/util.h"
+
+using namespace appimage::update;
+using namespace appimage::update::util;
+
+class HashCacheTest : public ::testing::Test {
+protected:
+    std::string tempDir;
+    std::string cacheDir;
+    std::string appImagePath;
+    mode_t previousUmask = 0;
+
+    void SetUp() override {
+        // mkdtemp() creates the directory accessible by the current user only, as required for the cache's parent
+        char pattern[] = "/tmp/appimageupdate-test-XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+
+        tempDir = pattern;
+        cacheDir = tempDir + "/cache";
+        appImagePath = tempDir + "/test.AppImage";
+
+        std::ofstream(appImagePath) << "not an actual AppImage, but the SHA-1 digest can be calculated anyway";
+
+        // files modified within the last two seconds are not cached
+        std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+        // the default on systems using user private groups, e.g., Debian and Ubuntu
+        previousUmask = umask(002);
+    }
+
+    void TearDown() override {
+        umask(previousUmask);
+        std::filesystem::remove_all(tempDir);
+    }
+
+    [[nodiscard]] std::vector<std::string> entries() const {
+        std::vector<std::string> paths;
+
+        for (const auto& file : std::filesystem::directory_iterator(cacheDir)) {
+            paths.emplace_back(file.path().string());
+        }
+
+        return paths;
+    }
+};
+
+TEST_F(HashCacheTest, EntriesArePrivateDespiteUmask) {
+    const HashCache hashCache(cacheDir);
+
+    (void) hashCache.calculateSha1Hash(UpdatableAppImage(appImagePath));
+
+    const auto paths = entries();
+    ASSERT_EQ(paths.size(), 1);
+    EXPECT_TRUE(isPrivateFile(paths.front()));
+    EXPECT_TRUE(isPrivateDirectory(cacheDir));
+}
+
+TEST_F(HashCacheTest, StoredEntryIsUsed) {
+    const HashCache hashCache(cacheDir);
+
+    const auto digest = hashCache.calculateSha1Hash(UpdatableAppImage(appImagePath));
+    ASSERT_FALSE(digest.empty());
+
+    const auto paths = entries();
+    ASSERT_EQ(paths.size(), 1);
+
+    // a cache hit is recognized by the digest stored in the entry, which is replaced with a made-up one
+    // truncating the existing file retains its permissions
+    std::string header;
+    std::getline(std::ifstream(paths.front()), header);
+    std::ofstream(paths.front(), std::ios::trunc) << header << std::endl << "sha1 cached" << std::endl;
+
+    EXPECT_EQ(hashCache.calculateSha1Hash(UpdatableAppImage(appImagePath)), "cached");
+}
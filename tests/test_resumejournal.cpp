@@ -0,0 +1,101 @@
+// system headers
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "util/resumejournal.h"
+#include "util/util.h"
+
+using namespace appimage::update;
+using namespace appimage::update::util;
+
+class ResumeJournalTest : public ::testing::Test {
+protected:
+    std::string tempDir;
+    std::string journalDir;
+    std::string appImagePath;
+    std::string partialFilePath;
+    const std::string zsyncUrl = "https://example.com/test.AppImage.zsync";
+    mode_t previousUmask = 0;
+
+    void SetUp() override {
+        // mkdtemp() creates the directory accessible by the current user only, as required for the journal's parent
+        char pattern[] = "/tmp/appimageupdate-test-XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+
+        tempDir = pattern;
+        journalDir = tempDir + "/resume";
+        appImagePath = tempDir + "/test.AppImage";
+        partialFilePath = tempDir + "/test-2.AppImage.part";
+
+        // the default on systems using user private groups, e.g., Debian and Ubuntu
+        previousUmask = umask(002);
+
+        // like zsync, create the partial output with the permissions the umask permits
+        std::ofstream(partialFilePath) << "partial output";
+    }
+
+    void TearDown() override {
+        umask(previousUmask);
+        std::filesystem::remove_all(tempDir);
+    }
+};
+
+TEST_F(ResumeJournalTest, RecordedPartialFileIsResumedDespiteUmask) {
+    const ResumeJournal journal(journalDir);
+
+    ASSERT_TRUE(journal.record(appImagePath, zsyncUrl, partialFilePath));
+    EXPECT_FALSE(std::filesystem::exists(partialFilePath));
+
+    const auto preservedPath = journal.partialFile(appImagePath, zsyncUrl);
+    ASSERT_FALSE(preservedPath.empty());
+    EXPECT_TRUE(isPrivateFile(preservedPath));
+
+    journal.remove(appImagePath);
+    EXPECT_FALSE(std::filesystem::exists(preservedPath));
+    EXPECT_TRUE(std::filesystem::is_empty(journalDir));
+}
+
+TEST_F(ResumeJournalTest, PartialFileOfDifferentUrlIsRemoved) {
+    const ResumeJournal journal(journalDir);
+
+    ASSERT_TRUE(journal.record(appImagePath, zsyncUrl, partialFilePath));
+
+    EXPECT_TRUE(journal.partialFile(appImagePath, zsyncUrl + ".new").empty());
+    EXPECT_TRUE(std::filesystem::is_empty(journalDir));
+}
+
+TEST_F(ResumeJournalTest, UntrustedEntryIsRemovedAlongWithPartialFile) {
+    const ResumeJournal journal(journalDir);
+
+    ASSERT_TRUE(journal.record(appImagePath, zsyncUrl, partialFilePath));
+
+    // entries written by previous versions were group-writable with this umask
+    for (const auto& file : std::filesystem::directory_iterator(journalDir)) {
+        chmod(file.path().c_str(), 0664);
+    }
+
+    EXPECT_TRUE(journal.partialFile(appImagePath, zsyncUrl).empty());
+    EXPECT_TRUE(std::filesystem::is_empty(journalDir));
+}
+
+TEST_F(ResumeJournalTest, ExpiredEntryIsPruned) {
+    const ResumeJournal journal(journalDir);
+
+    ASSERT_TRUE(journal.record(appImagePath, zsyncUrl, partialFilePath));
+
+    const auto expired = std::filesystem::file_time_type::clock::now() - std::chrono::hours(8 * 24);
+
+    for (const auto& file : std::filesystem::directory_iterator(journalDir)) {
+        std::filesystem::last_write_time(file.path(), expired);
+    }
+
+    // the journal is pruned when it is used for any AppImage
+    EXPECT_TRUE(journal.partialFile(tempDir + "/other.AppImage", zsyncUrl).empty());
+    EXPECT_TRUE(std::filesystem::is_empty(journalDir));
+}
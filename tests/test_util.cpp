@@ -0,0 +1,24 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "util/util.h"
+
+using namespace appimage::update::util;
+
+TEST(ApplicationNameFromFileNameTest, VersionIsRemoved) {
+    EXPECT_EQ(applicationNameFromFileName("Krita-5.2.0-x86_64.AppImage"), "krita");
+    EXPECT_EQ(applicationNameFromFileName("Inkscape_1.3.2.AppImage"), "inkscape");
+    EXPECT_EQ(applicationNameFromFileName("Some App 2.0.AppImage"), "some app");
+}
+
+TEST(ApplicationNameFromFileNameTest, ArchitectureIsNotMistakenForVersion) {
+    EXPECT_EQ(applicationNameFromFileName("appimagetool-x86_64.AppImage"), "appimagetool");
+    EXPECT_EQ(applicationNameFromFileName("appimagetool-i686.AppImage"), "appimagetool");
+    EXPECT_EQ(applicationNameFromFileName("MyApp-1.0-aarch64.AppImage"), "myapp");
+}
+
+TEST(ApplicationNameFromFileNameTest, UnversionedFileNameIsKept) {
+    EXPECT_EQ(applicationNameFromFileName("MyApp.AppImage"), "myapp");
+    EXPECT_EQ(applicationNameFromFileName("myapp"), "myapp");
+}